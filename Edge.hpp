@@ -61,8 +61,8 @@ public:
       return e.getFirstNode()->getId() == n1->getId() && e.getSecondNode()->getId() == n2->getId();
     }
 
-    return e.getFirstNode()->getId() == n1->getId() && e.getSecondNode()->getId() == n2->getId() ||
-             e.getFirstNode()->getId() == n2->getId() && e.getSecondNode()->getId() == n1->getId();
+    return (e.getFirstNode()->getId() == n1->getId() && e.getSecondNode()->getId() == n2->getId()) ||
+             (e.getFirstNode()->getId() == n2->getId() && e.getSecondNode()->getId() == n1->getId());
 
     }
 
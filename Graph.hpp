@@ -7,6 +7,7 @@
 #include <memory>
 #include "Node.hpp"
 #include "Edge.hpp"
+#include "Range.hpp"
 
 template<typename NODEVAL, typename EDGEVAL, bool isDirected = false,
             template<typename> typename NODETYPE = Node,
@@ -20,6 +21,11 @@ class Graph
 	std::vector<std::shared_ptr<NODE> > nodes;
 	std::vector<std::shared_ptr<EDGE> > edges;
 public:
+	// non-owning views over the nodes and edges of the graph and over the adjacent nodes of a node
+	using NodeRange = Range<typename std::vector<std::shared_ptr<NODE> >::const_iterator, NODE>;
+	using EdgeRange = Range<typename std::vector<std::shared_ptr<EDGE> >::const_iterator, EDGE>;
+	using AdjacencyRange = Range<typename std::set<std::shared_ptr<Node<NODEVAL> > >::const_iterator, NODE>;
+
     // default constructor
 	Graph<NODEVAL, EDGEVAL, isDirected, NODETYPE, EDGETYPE>() = default;
 
@@ -68,7 +74,8 @@ public:
 	}
 
 	/**
-	 * @brief Add a new edge between two given nodes if not existant
+	 * @brief Add a new edge between two given nodes if not existant. n2 becomes adjacent to n1 and,
+	 * unless the edge is directed, n1 becomes adjacent to n2.
 	 * @param n1 is a pointer to the target node
 	 * @param n2 is a pointer to the destination node
  	 * @param directed must be true if the edge should be directed, else false
@@ -82,6 +89,10 @@ public:
 
 		if(isExistantIt == edges.end()) {
 			edges.push_back(edge);
+			n1->addAdjacentNode(n2);
+			if(!isDirected && !directed) {
+				n2->addAdjacentNode(n1);
+			}
 
 			isExistantIt = edges.end();
 			--isExistantIt;
@@ -97,7 +108,7 @@ public:
 	 * @param n2 is a pointer to the destination node
 	 * @return a pointer to the edge
      */
-	std::shared_ptr<NODE> addEdge(std::shared_ptr<NODE> n1, std::shared_ptr<NODE> n2) {
+	std::shared_ptr<EDGE> addEdge(std::shared_ptr<NODE> n1, std::shared_ptr<NODE> n2) {
 		return addEdge(n1, n2, false);
 	}
 
@@ -117,6 +128,35 @@ public:
 		return edges;
 	}
 
+	/**
+	 * @brief Get a non-owning view over all nodes of the graph. Unlike getNodes(), nothing is copied;
+	 * the view is invalidated when nodes are added or removed.
+	 * @return a range yielding references to all nodes of the graph
+     */
+	NodeRange nodeRange() const {
+		return NodeRange(nodes.cbegin(), nodes.cend(), nodes.size());
+	}
+
+	/**
+	 * @brief Get a non-owning view over all edges of the graph. Unlike getEdges(), nothing is copied;
+	 * the view is invalidated when edges are added or removed.
+	 * @return a range yielding references to all edges of the graph
+	 */
+	EdgeRange edgeRange() const {
+		return EdgeRange(edges.cbegin(), edges.cend(), edges.size());
+	}
+
+	/**
+	 * @brief Get a non-owning view over the adjacent nodes of a node of this graph. The adjacent
+	 * nodes are yielded as NODE references, so no dynamic_pointer_cast is needed.
+	 * @param node a node of this graph
+	 * @return a range yielding references to all adjacent nodes of the given node
+	 */
+	AdjacencyRange adjacentNodes(NODE &node) const {
+		auto &adjacent = node.getAdjacentNodes();
+		return AdjacencyRange(adjacent.cbegin(), adjacent.cend(), adjacent.size());
+	}
+
     /** \brief Check if a given node is contained in the graph
      * \param node a pointer to the node that should be checked
      * \return bool true if the node is contained in the graph, else false
@@ -138,6 +178,28 @@ public:
             for(auto node : nodes) {
                node->removeAdjacentNode(delnode);
             }
+            edges.erase(std::remove_if(edges.begin(), edges.end(), [&delnode](const std::shared_ptr<EDGE> &edge) {
+                return edge->getFirstNode() == delnode || edge->getSecondNode() == delnode;
+            }), edges.end());
+            return true;
+        }
+        return false;
+	}
+
+    /** \brief Remove the edge between two given nodes.
+     * \param n1 a pointer to the source node
+     * \param n2 a pointer to the target node
+     * \return true if the edge was existent in the graph and removed successful, else false.
+     */
+	bool removeEdge(std::shared_ptr<NODE> n1, std::shared_ptr<NODE> n2) {
+        EDGE delEdge(n1, n2);
+        auto it = std::find_if(edges.begin(), edges.end(), [&delEdge](const std::shared_ptr<EDGE> &edge) { return delEdge == *edge; });
+        if(it != edges.end()) {
+            edges.erase(it);
+            n1->removeAdjacentNode(n2);
+            if(!isDirected) {
+                n2->removeAdjacentNode(n1);
+            }
             return true;
         }
         return false;
@@ -4,6 +4,9 @@
 #include <set>
 #include <initializer_list>
 #include <algorithm>
+#include <atomic>
+#include <memory>
+#include <ostream>
 
 
 template<class T>
@@ -14,22 +17,20 @@ class Node
 	std::set<std::shared_ptr<Node<T> > > adjacentNodes;
 
 	// unique ids
-	static unsigned instanceCount; // initialized at the end of this file
+	static std::atomic<unsigned> instanceCount; // initialized at the end of this file; atomic because graphs may be built concurrently
 	unsigned privateId;
 
 public:
 	/**
 	 * @brief Constructor for value only instantiation
      */
-	Node(T val) : value(val), privateId(instanceCount) {
-		instanceCount++;
+	Node(T val) : value(val), privateId(instanceCount++) {
 	}
 
 	/**
 	 * @brief Constructor for value and adjacent node instantiation
      */
-	Node(T value, std::initializer_list<std::shared_ptr<Node<T> > > nodes) : value(value), adjacentNodes(nodes), privateId(instanceCount) {
-		instanceCount++;
+	Node(T value, std::initializer_list<std::shared_ptr<Node<T> > > nodes) : value(value), adjacentNodes(nodes), privateId(instanceCount++) {
 	}
 
 	/**
@@ -125,5 +126,5 @@ public:
 };
 
 template<class T>
-unsigned Node<T>::instanceCount = 0;
+std::atomic<unsigned> Node<T>::instanceCount(0);
 #endif
@@ -0,0 +1,105 @@
+/******************************************
+ * Non-owning range views intended for graph usage.
+ * A range iterates over a container of (smart) pointers and yields
+ * plain references to the pointees, so no pointer is copied and no
+ * reference count is touched while iterating.
+ */
+
+#ifndef __RANGE_HPP_
+#define __RANGE_HPP_
+
+#include <iterator>
+#include <cstddef>
+
+/** \brief Iterator adapter dereferencing the pointers of an underlying iterator.
+ * The pointee is static_cast to VALUE, which allows iterating over base class
+ * pointers (e.g. the adjacent nodes of a Node<T>) as references to the derived type.
+ */
+template<typename ITERATOR, typename VALUE>
+class DereferencingIterator
+{
+    ITERATOR it;
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = VALUE;
+    using difference_type = std::ptrdiff_t;
+    using pointer = VALUE*;
+    using reference = VALUE&;
+
+    DereferencingIterator() = default;
+    explicit DereferencingIterator(ITERATOR it) : it(it) { };
+
+    reference operator*() const {
+        return static_cast<reference>(**it);
+    }
+
+    pointer operator->() const {
+        return &**this;
+    }
+
+    DereferencingIterator &operator++() {
+        ++it;
+        return *this;
+    }
+
+    DereferencingIterator operator++(int) {
+        DereferencingIterator old = *this;
+        ++it;
+        return old;
+    }
+
+    bool operator==(const DereferencingIterator &other) const {
+        return it == other.it;
+    }
+
+    bool operator!=(const DereferencingIterator &other) const {
+        return it != other.it;
+    }
+};
+
+/** \brief A lightweight [begin, end) view over a container of pointers.
+ * The view does not own anything; it is invalidated by every operation
+ * that invalidates the iterators of the underlying container.
+ */
+template<typename ITERATOR, typename VALUE>
+class Range
+{
+    ITERATOR first, last;
+    std::size_t count;
+public:
+    using iterator = DereferencingIterator<ITERATOR, VALUE>;
+
+    Range(ITERATOR first, ITERATOR last, std::size_t count) : first(first), last(last), count(count) { };
+
+    iterator begin() const {
+        return iterator(first);
+    }
+
+    iterator end() const {
+        return iterator(last);
+    }
+
+    /** \brief get an element by its position; only available for views over random access containers.
+     * \param index std::size_t the position of the element
+     * \return a reference to the element.
+     */
+    VALUE &operator[](std::size_t index) const {
+        return static_cast<VALUE&>(*first[index]);
+    }
+
+    /** \brief get the number of elements in the range.
+     * \return the number of elements.
+     */
+    std::size_t size() const {
+        return count;
+    }
+
+    /** \brief check if the range is empty.
+     * \return true if there are no elements in the range, else false.
+     */
+    bool empty() const {
+        return count == 0;
+    }
+};
+
+#endif // __RANGE_HPP_
@@ -0,0 +1,233 @@
+/******************************************
+ * Headless batch layout of many graphs.
+ *
+ * Usage: GraphBatch <input directory> <output directory> [options]
+ *   --threads N         number of worker threads (default: all cores)
+ *   --max-iterations N  upper bound of update() calls per graph (default: 5000)
+ *   --epsilon E         a layout has converged once no node moves further (default: 0.05)
+ *   --png               additionally render a PNG through an offscreen render texture
+ *
+ * Every regular file of the input directory is read as a graph file (see GraphIO.hpp)
+ * and laid out by its own ExpandingGraphManager on a work stealing pool. For
+ * <name>.<ext> the files <name>.json and <name>.svg (and <name>.png) are written.
+ */
+
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <dirent.h>
+#include <sys/stat.h>
+#include "Graph.hpp"
+#include "GUINode.h"
+#include "ExpandingGraphManager.h"
+#include "GraphIO.hpp"
+#include "WorkStealingPool.h"
+
+
+#define WIDTH 1000
+#define HEIGHT 1000
+#define RADIUS 10
+
+using BatchGraph = Graph<std::string, bool, false, GUINode>;
+
+struct BatchOptions {
+    std::string inputDirectory, outputDirectory;
+    unsigned threads = 0;
+    unsigned maxIterations = 5000;
+    double epsilon = 0.05;
+    bool png = false;
+};
+
+// SFML creates a GL context per render texture; keep the offscreen rendering serialized
+std::mutex renderMutex;
+std::mutex logMutex;
+
+/** \brief Render a graph into a PNG file the same way drawGraph() draws it into the window.
+ * \return bool true if the file was written, else false
+ */
+bool writePng(BatchGraph &graph, const std::string &path) {
+    std::lock_guard<std::mutex> lock(renderMutex);
+
+    sf::RenderTexture target;
+    if(!target.create(WIDTH, HEIGHT)) return false;
+    target.clear();
+
+    for(GUINode<std::string> &node : graph.nodeRange()) {
+        for(GUINode<std::string> &adjacentNode : graph.adjacentNodes(node)) {
+            sf::Vertex line[] =
+            {
+                sf::Vertex(sf::Vector2f(node.getPosition().at(0) + RADIUS, node.getPosition().at(1)+ RADIUS)),
+                sf::Vertex(sf::Vector2f(adjacentNode.getPosition().at(0) + RADIUS, adjacentNode.getPosition().at(1) + RADIUS))
+            };
+
+            target.draw(line, 2, sf::Lines);
+        }
+    }
+
+    std::vector<GUINode<std::string>*> sortedNodes;
+    for(GUINode<std::string> &node : graph.nodeRange()) {
+        sortedNodes.push_back(&node);
+    }
+    std::sort(sortedNodes.begin(), sortedNodes.end(), [](GUINode<std::string> *node1, GUINode<std::string> *node2) { return node1->getPosition().at(2) < node2->getPosition().at(2); });
+    for(GUINode<std::string> *node : sortedNodes) {
+        sf::Texture texture;
+        if(!texture.loadFromFile(node->getPathToImage())) continue;
+        sf::Sprite sprite;
+        sprite.setTexture(texture);
+        sprite.setPosition(node->getPosition().at(0), node->getPosition().at(1));
+
+        target.draw(sprite);
+    }
+
+    target.display();
+    return target.getTexture().copyToImage().saveToFile(path);
+}
+
+/** \brief Release the nodes of a graph. The adjacent nodes of undirected nodes point at each
+ * other, so the shared_ptr cycles have to be broken before the graph goes out of scope.
+ */
+void releaseGraph(BatchGraph &graph) {
+    for(GUINode<std::string> &node : graph.nodeRange()) {
+        node.getAdjacentNodes().clear();
+    }
+}
+
+/** \brief Lay out a single graph file and write its outputs.
+ * \return bool true on success, else false
+ */
+bool layoutGraphFile(const BatchOptions &options, const std::string &fileName) {
+    std::string baseName = fileName.substr(0, fileName.find_last_of('.'));
+    if(baseName.empty()) baseName = fileName;
+    std::string outputBase = options.outputDirectory + "/" + baseName;
+
+    BatchGraph graph;
+    std::ifstream in(options.inputDirectory + "/" + fileName);
+    std::string error;
+    if(!in || !GraphIO::readGraph(in, graph, error)) {
+        releaseGraph(graph);
+        std::lock_guard<std::mutex> lock(logMutex);
+        std::cerr << fileName << ": " << (in ? error : "cannot open file") << std::endl;
+        return false;
+    }
+
+    ExpandingGraphManager<std::string, bool, false, GUINode> gm(graph, WIDTH, HEIGHT, RADIUS);
+    unsigned iteration = 0;
+    while(iteration < options.maxIterations && gm.update() > options.epsilon) {
+        ++iteration;
+    }
+    gm.removeOverlaps();
+
+    std::ofstream json(outputBase + ".json"), svg(outputBase + ".svg");
+    GraphIO::writeJson(json, graph);
+    GraphIO::writeSvg(svg, graph, RADIUS);
+    bool success = json.good() && svg.good();
+    if(options.png) success = writePng(graph, outputBase + ".png") && success;
+    size_t nodeCount = graph.nodeRange().size();
+    releaseGraph(graph);
+
+    std::lock_guard<std::mutex> lock(logMutex);
+    if(success) {
+        std::cout << fileName << ": " << nodeCount << " nodes, "
+                  << (iteration < options.maxIterations ? "converged after " : "stopped after ")
+                  << iteration << " iterations" << std::endl;
+    } else {
+        std::cerr << fileName << ": cannot write output" << std::endl;
+    }
+    return success;
+}
+
+/** \brief Get the names of all regular files in a directory, sorted by name.
+ */
+std::vector<std::string> listGraphFiles(const std::string &directory) {
+    std::vector<std::string> files;
+    DIR *dir = opendir(directory.c_str());
+    if(dir == nullptr) return files;
+
+    while(dirent *entry = readdir(dir)) {
+        std::string name = entry->d_name;
+        struct stat info;
+        if(name[0] == '.' || stat((directory + "/" + name).c_str(), &info) != 0 || !S_ISREG(info.st_mode)) continue;
+        files.push_back(name);
+    }
+    closedir(dir);
+
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+bool parseArguments(int argc, char **argv, BatchOptions &options) {
+    std::vector<std::string> positional;
+    for(int i = 1; i < argc; ++i) {
+        std::string argument = argv[i];
+        if(argument == "--png") {
+            options.png = true;
+        } else if(argument == "--threads" && i + 1 < argc) {
+            options.threads = std::strtoul(argv[++i], nullptr, 10);
+        } else if(argument == "--max-iterations" && i + 1 < argc) {
+            options.maxIterations = std::strtoul(argv[++i], nullptr, 10);
+        } else if(argument == "--epsilon" && i + 1 < argc) {
+            options.epsilon = std::strtod(argv[++i], nullptr);
+        } else if(argument.compare(0, 2, "--") == 0) {
+            return false;
+        } else {
+            positional.push_back(argument);
+        }
+    }
+    if(positional.size() != 2) return false;
+
+    options.inputDirectory = positional[0];
+    options.outputDirectory = positional[1];
+    return true;
+}
+
+
+int main(int argc, char **argv)
+{
+    BatchOptions options;
+    if(!parseArguments(argc, argv, options)) {
+        std::cerr << "usage: " << argv[0] << " <input directory> <output directory>"
+                  << " [--threads N] [--max-iterations N] [--epsilon E] [--png]" << std::endl;
+        return 2;
+    }
+
+    std::vector<std::string> files = listGraphFiles(options.inputDirectory);
+    if(files.empty()) {
+        std::cerr << options.inputDirectory << ": no graph files found" << std::endl;
+        return 1;
+    }
+    mkdir(options.outputDirectory.c_str(), 0755);
+
+    std::atomic<unsigned> failures(0);
+    auto start = std::chrono::steady_clock::now();
+    unsigned threadCount;
+    {
+        WorkStealingPool pool(options.threads);
+        threadCount = pool.size();
+        for(const std::string &file : files) {
+            pool.submit([&options, &failures, file] {
+                try {
+                    if(!layoutGraphFile(options, file)) ++failures;
+                } catch(const std::exception &e) {
+                    std::lock_guard<std::mutex> lock(logMutex);
+                    std::cerr << file << ": " << e.what() << std::endl;
+                    ++failures;
+                }
+            });
+        }
+        pool.wait();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << files.size() << " graphs on " << threadCount << " threads in " << seconds << " s ("
+              << (seconds > 0 ? files.size() * 60 / seconds : 0) << " graphs/min), "
+              << failures << " failed" << std::endl;
+
+    return failures == 0 ? 0 : 1;
+}
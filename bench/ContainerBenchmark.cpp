@@ -0,0 +1,344 @@
+/******************************************
+ * Microbenchmarks of the core containers:
+ * Graph::addNode, addEdge, removeNode and contains,
+ * Node::addAdjacentNode and removeAdjacentNode and
+ * Edge::operator==, each at 10^3 up to 10^6 elements.
+ *
+ * Uses Graph.hpp, Node.hpp, Edge.hpp and Range.hpp of the repository root
+ * only, so it builds without SFML and armadillo. Build it from bench/:
+ *   g++ -std=c++14 -O2 -I.. -o ContainerBenchmark ContainerBenchmark.cpp
+ *
+ * Usage: ContainerBenchmark [options]
+ *   --max-size N     largest container size (default: 1000000)
+ *   --min-time S     seconds spent per benchmark and size (default: 0.2)
+ *   --filter TEXT    only run benchmarks whose name contains TEXT
+ *   --baseline FILE  compare the results against a baseline file
+ *   --threshold P    a result regresses if it is more than P percent worse than the baseline (default: 10)
+ *   --save FILE      write the results as new baseline file
+ *
+ * Baseline files contain one "<benchmark> <size> <ns/op> <allocs/op>" line per result.
+ * The exit code is 1 if a result regressed, else 0.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include "Graph.hpp"
+
+
+// every allocation goes through these, so the timed region can count them
+static unsigned long long allocationCount = 0;
+
+void *operator new(size_t size) {
+    ++allocationCount;
+    if(void *memory = std::malloc(size ? size : 1)) return memory;
+    throw std::bad_alloc();
+}
+
+// g++ 11+ can't tell that the replaced operator new above is malloc and warns about every free below
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void operator delete(void *memory) noexcept {
+    std::free(memory);
+}
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic pop
+#endif
+
+void operator delete(void *memory, size_t) noexcept {
+    operator delete(memory);
+}
+
+// the array forms too, so every new is paired with its own delete
+void *operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete[](void *memory) noexcept {
+    operator delete(memory);
+}
+
+void operator delete[](void *memory, size_t) noexcept {
+    operator delete(memory);
+}
+
+using BenchGraph = Graph<int, int>;
+using BenchNode = Node<int>;
+using BenchEdge = Edge<int, BenchNode, false>;
+
+struct BenchmarkOptions {
+    size_t maxSize = 1000000;
+    double minTime = 0.2;
+    std::string filter, baselineFile, saveFile;
+    double threshold = 10;
+};
+
+struct Benchmark {
+    std::string name;
+    // builds a fixture of the given size and returns the operation to time; the operation
+    // receives the number of the call and is called at most callLimit(size) times
+    std::function<std::function<void(size_t)>(size_t)> prepare;
+    std::function<size_t(size_t)> callLimit;
+};
+
+struct Result {
+    double nsPerOp, allocsPerOp;
+};
+
+/** \brief A chain graph 0 - 1 - ... - n-1, built without the duplicate check of addEdge.
+ * The adjacency of undirected nodes forms shared_ptr cycles, so they are broken on destruction.
+ */
+struct ChainFixture {
+    BenchGraph graph;
+    std::vector<std::shared_ptr<BenchNode> > nodes;
+
+    explicit ChainFixture(size_t size) {
+        nodes.reserve(size);
+        nodes.push_back(graph.addNode(0));
+        for(size_t i = 1; i < size; ++i) {
+            nodes.push_back(graph.addNode(i, { nodes.back() }));
+        }
+    }
+
+    ~ChainFixture() {
+        for(auto &node : nodes) {
+            node->getAdjacentNodes().clear();
+        }
+    }
+};
+
+/** \brief Get the indices 0..size-1 in a fixed pseudo random order, so every run touches the same elements.
+ */
+std::vector<size_t> shuffledIndices(size_t size) {
+    std::vector<size_t> indices(size);
+    for(size_t i = 0; i < size; ++i) indices[i] = i;
+    std::shuffle(indices.begin(), indices.end(), std::mt19937(42));
+    return indices;
+}
+
+// keeps the compiler from dropping the result of pure operations
+static volatile size_t sink;
+
+std::vector<Benchmark> createBenchmarks() {
+    std::vector<Benchmark> benchmarks;
+
+    // appends to a graph that already holds size nodes
+    benchmarks.push_back({ "Graph::addNode", [](size_t size) {
+        auto graph = std::make_shared<BenchGraph>();
+        for(size_t i = 0; i < size; ++i) graph->addNode(i);
+        return std::function<void(size_t)>([graph](size_t call) { graph->addNode(call); });
+    }, [](size_t size) { return size; } });
+
+    // new edges between nodes of a chain with size edges; every call scans all edges
+    benchmarks.push_back({ "Graph::addEdge", [](size_t size) {
+        auto fixture = std::make_shared<ChainFixture>(size);
+        auto order = std::make_shared<std::vector<size_t> >(shuffledIndices(size - 2));
+        return std::function<void(size_t)>([fixture, order](size_t call) {
+            size_t first = (*order)[call];
+            fixture->graph.addEdge(fixture->nodes[first], fixture->nodes[first + 2]);
+        });
+    }, [](size_t size) { return size / 10; } });
+
+    benchmarks.push_back({ "Graph::removeNode", [](size_t size) {
+        auto fixture = std::make_shared<ChainFixture>(size);
+        auto order = std::make_shared<std::vector<size_t> >(shuffledIndices(size));
+        return std::function<void(size_t)>([fixture, order](size_t call) {
+            auto &node = fixture->nodes[(*order)[call]];
+            fixture->graph.removeNode(node);
+            node->getAdjacentNodes().clear();
+        });
+    }, [](size_t size) { return size / 10; } });
+
+    benchmarks.push_back({ "Graph::contains", [](size_t size) {
+        auto fixture = std::make_shared<ChainFixture>(size);
+        auto order = std::make_shared<std::vector<size_t> >(shuffledIndices(size));
+        return std::function<void(size_t)>([fixture, order](size_t call) {
+            sink = fixture->graph.contains(fixture->nodes[(*order)[call % order->size()]]);
+        });
+    }, [](size_t size) { return 10 * size; } });
+
+    // a hub node that is adjacent to size other nodes
+    auto prepareHub = [](size_t size, bool connected) {
+        auto hub = std::make_shared<BenchNode>(-1);
+        auto others = std::make_shared<std::vector<std::shared_ptr<BenchNode> > >();
+        others->reserve(size);
+        for(size_t i = 0; i < size; ++i) {
+            others->push_back(std::make_shared<BenchNode>(i));
+            if(connected) hub->addAdjacentNode(others->back());
+        }
+        auto order = std::make_shared<std::vector<size_t> >(shuffledIndices(size));
+        return std::make_tuple(hub, others, order);
+    };
+
+    benchmarks.push_back({ "Node::addAdjacentNode", [prepareHub](size_t size) {
+        auto fixture = prepareHub(size, false);
+        return std::function<void(size_t)>([fixture](size_t call) {
+            std::get<0>(fixture)->addAdjacentNode((*std::get<1>(fixture))[(*std::get<2>(fixture))[call]]);
+        });
+    }, [](size_t size) { return size; } });
+
+    benchmarks.push_back({ "Node::removeAdjacentNode", [prepareHub](size_t size) {
+        auto fixture = prepareHub(size, true);
+        return std::function<void(size_t)>([fixture](size_t call) {
+            std::get<0>(fixture)->removeAdjacentNode((*std::get<1>(fixture))[(*std::get<2>(fixture))[call]]);
+        });
+    }, [](size_t size) { return size / 2; } });
+
+    // compares a probe against size distinct edges, as the duplicate check of addEdge does
+    benchmarks.push_back({ "Edge::operator==", [](size_t size) {
+        auto nodes = std::make_shared<std::vector<std::shared_ptr<BenchNode> > >();
+        auto edges = std::make_shared<std::vector<BenchEdge> >();
+        nodes->reserve(size + 1);
+        edges->reserve(size);
+        nodes->push_back(std::make_shared<BenchNode>(0));
+        for(size_t i = 1; i <= size; ++i) {
+            nodes->push_back(std::make_shared<BenchNode>(i));
+            edges->emplace_back((*nodes)[i - 1], (*nodes)[i]);
+        }
+        auto probe = std::make_shared<BenchEdge>(nodes->back(), nodes->front());
+        return std::function<void(size_t)>([nodes, edges, probe](size_t call) {
+            sink = *probe == (*edges)[call % edges->size()];
+        });
+    }, [](size_t size) { return 100 * size; } });
+
+    return benchmarks;
+}
+
+/** \brief Time an operation in doubling batches until minTime has passed or the call limit is reached.
+ */
+Result measure(const Benchmark &benchmark, size_t size, double minTime) {
+    std::function<void(size_t)> operation = benchmark.prepare(size);
+    size_t limit = std::max<size_t>(1, benchmark.callLimit(size));
+
+    size_t calls = 0, batch = 1;
+    double seconds = 0;
+    unsigned long long allocations = 0;
+    while(calls < limit && seconds < minTime) {
+        batch = std::min(batch, limit - calls);
+        unsigned long long allocationsBefore = allocationCount;
+        auto start = std::chrono::steady_clock::now();
+        for(size_t call = calls; call < calls + batch; ++call) {
+            operation(call);
+        }
+        seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        allocations += allocationCount - allocationsBefore;
+        calls += batch;
+        batch *= 2;
+    }
+    return { seconds * 1e9 / calls, double(allocations) / calls };
+}
+
+/** \brief Read a baseline file.
+ * \return bool true if the file could be read, else false
+ */
+bool readBaseline(const std::string &path, std::map<std::pair<std::string, size_t>, Result> &baseline) {
+    std::ifstream in(path);
+    if(!in) return false;
+
+    std::string line;
+    while(std::getline(in, line)) {
+        std::istringstream fields(line);
+        std::string name;
+        size_t size;
+        Result result;
+        if(fields >> name >> size >> result.nsPerOp >> result.allocsPerOp) baseline[{ name, size }] = result;
+    }
+    return true;
+}
+
+bool parseArguments(int argc, char **argv, BenchmarkOptions &options) {
+    for(int i = 1; i < argc; ++i) {
+        std::string argument = argv[i];
+        if(i + 1 >= argc) return false;
+        if(argument == "--max-size") {
+            options.maxSize = std::strtoul(argv[++i], nullptr, 10);
+        } else if(argument == "--min-time") {
+            options.minTime = std::strtod(argv[++i], nullptr);
+        } else if(argument == "--filter") {
+            options.filter = argv[++i];
+        } else if(argument == "--baseline") {
+            options.baselineFile = argv[++i];
+        } else if(argument == "--threshold") {
+            options.threshold = std::strtod(argv[++i], nullptr);
+        } else if(argument == "--save") {
+            options.saveFile = argv[++i];
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+int main(int argc, char **argv)
+{
+    BenchmarkOptions options;
+    if(!parseArguments(argc, argv, options)) {
+        std::cerr << "usage: " << argv[0] << " [--max-size N] [--min-time S] [--filter TEXT]"
+                  << " [--baseline FILE] [--threshold P] [--save FILE]" << std::endl;
+        return 2;
+    }
+
+    std::map<std::pair<std::string, size_t>, Result> baseline;
+    if(!options.baselineFile.empty() && !readBaseline(options.baselineFile, baseline)) {
+        std::cerr << options.baselineFile << ": cannot read baseline" << std::endl;
+        return 2;
+    }
+
+    std::ofstream save;
+    if(!options.saveFile.empty()) {
+        save.open(options.saveFile);
+        if(!save) {
+            std::cerr << options.saveFile << ": cannot write baseline" << std::endl;
+            return 2;
+        }
+    }
+
+    std::printf("%-26s %9s %14s %11s %14s %9s\n", "benchmark", "size", "ns/op", "allocs/op", "baseline ns/op", "change");
+    unsigned regressions = 0;
+    for(const Benchmark &benchmark : createBenchmarks()) {
+        if(benchmark.name.find(options.filter) == std::string::npos) continue;
+
+        for(size_t size = 1000; size <= options.maxSize; size *= 10) {
+            Result result = measure(benchmark, size, options.minTime);
+            std::printf("%-26s %9zu %14.1f %11.2f", benchmark.name.c_str(), size, result.nsPerOp, result.allocsPerOp);
+            if(save) save << benchmark.name << " " << size << " " << result.nsPerOp << " " << result.allocsPerOp << "\n";
+
+            auto reference = baseline.find({ benchmark.name, size });
+            if(reference == baseline.end()) {
+                std::printf("\n");
+                std::fflush(stdout);
+                continue;
+            }
+
+            double change = (result.nsPerOp / reference->second.nsPerOp - 1) * 100;
+            // allocation counts are deterministic; the small slack only absorbs vector growth
+            bool slower = change > options.threshold;
+            bool allocating = result.allocsPerOp > reference->second.allocsPerOp * (1 + options.threshold / 100) + 0.01;
+            std::printf(" %14.1f %+8.1f%%%s\n", reference->second.nsPerOp, change,
+                        slower || allocating ? (allocating ? "  REGRESSION (allocs)" : "  REGRESSION") : "");
+            std::fflush(stdout);
+            if(slower || allocating) ++regressions;
+        }
+    }
+
+    if(!options.baselineFile.empty()) {
+        std::cout << regressions << " regression(s) beyond " << options.threshold << "%" << std::endl;
+    }
+    return regressions == 0 ? 0 : 1;
+}
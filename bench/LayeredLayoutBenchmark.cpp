@@ -0,0 +1,130 @@
+/******************************************
+ * Timing of LayeredGraphManager on generated
+ * directed acyclic graphs.
+ *
+ * Besides the graph headers it includes include/LayeredGraphManager.h, which
+ * runs the crossing minimisation on threads, and test/PlainNode.h instead of
+ * GUINode; neither needs SFML or armadillo. Build it from bench/:
+ *   g++ -std=c++14 -O2 -pthread -I.. -I../include -o LayeredLayoutBenchmark LayeredLayoutBenchmark.cpp
+ *
+ * Usage: LayeredLayoutBenchmark [options]
+ *   --nodes N        number of nodes (default: 50000)
+ *   --model M        how the dependencies of a node are picked (default: all models in turn):
+ *                      tiers    the nodes are spread over 12 tiers; a node depends on nodes of the
+ *                               tier below, one dependency in ten on any lower tier (a deployment)
+ *                      window   a node depends on nodes among the 100 nodes created before it
+ *                      uniform  a node depends on any nodes created before it
+ *   --seed S         seed of the generator (default: 1)
+ *
+ * Every node gets one to three distinct dependencies (about two edges per node). The time covers
+ * the constructor of LayeredGraphManager, i.e. one complete layout.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include "Graph.hpp"
+#include "LayeredGraphManager.h"
+#include "test/PlainNode.h"
+
+
+using BenchGraph = Graph<int, bool, true, PlainNode>;
+using BenchNode = PlainNode<int>;
+
+/** \brief Add a node with its dependencies. The edges go from the new node to its dependencies;
+ * addNode() with adjacent nodes doesn't search for duplicate edges, so generating stays linear.
+ */
+void addDependentNode(BenchGraph &graph, std::vector<std::shared_ptr<BenchNode> > &nodes, const std::vector<size_t> &dependencies) {
+    int value = nodes.size();
+    switch(dependencies.size()) {
+        case 0: nodes.push_back(graph.addNode(value)); break;
+        case 1: nodes.push_back(graph.addNode(value, { nodes[dependencies[0]] })); break;
+        case 2: nodes.push_back(graph.addNode(value, { nodes[dependencies[0]], nodes[dependencies[1]] })); break;
+        default: nodes.push_back(graph.addNode(value, { nodes[dependencies[0]], nodes[dependencies[1]], nodes[dependencies[2]] }));
+    }
+}
+
+/** \brief Generate a graph of one of the models described above.
+ */
+void generate(BenchGraph &graph, std::vector<std::shared_ptr<BenchNode> > &nodes, const std::string &model, size_t count, unsigned seed) {
+    const unsigned TIERS = 12, WINDOW = 100;
+    std::mt19937 rng(seed);
+
+    // the tier of every node; nodes are created tier by tier, so dependencies always exist already
+    std::vector<std::vector<size_t> > tiers(TIERS);
+    std::vector<unsigned> tierSizes(TIERS, 0);
+    for(size_t i = 0; i < count; ++i) {
+        ++tierSizes[i < 50 ? 0 : 1 + rng() % (TIERS - 1)];
+    }
+
+    unsigned tier = 0;
+    for(size_t i = 0; i < count; ++i) {
+        while(model == "tiers" && tiers[tier].size() == tierSizes[tier]) ++tier;
+
+        std::vector<size_t> dependencies;
+        unsigned wanted = 1 + rng() % 3;
+        for(unsigned attempt = 0; i > 0 && dependencies.size() < wanted && attempt < 10; ++attempt) {
+            size_t dependency;
+            if(model == "tiers") {
+                if(tier == 0) break;
+                unsigned span = rng() % 10 == 0 ? 1 + rng() % tier : 1;
+                auto &candidates = tiers[tier - span];
+                dependency = candidates[rng() % candidates.size()];
+            } else if(model == "window") {
+                dependency = i - 1 - rng() % std::min<size_t>(i, WINDOW);
+            } else {
+                dependency = rng() % i;
+            }
+            if(std::find(dependencies.begin(), dependencies.end(), dependency) == dependencies.end()) dependencies.push_back(dependency);
+        }
+
+        addDependentNode(graph, nodes, dependencies);
+        if(model == "tiers") tiers[tier].push_back(i);
+    }
+}
+
+
+int main(int argc, char **argv)
+{
+    size_t count = 50000;
+    unsigned seed = 1;
+    std::vector<std::string> models = { "tiers", "window", "uniform" };
+    for(int i = 1; i + 1 < argc; i += 2) {
+        std::string argument = argv[i];
+        if(argument == "--nodes") {
+            count = std::strtoul(argv[i + 1], nullptr, 10);
+        } else if(argument == "--model") {
+            models = { argv[i + 1] };
+        } else if(argument == "--seed") {
+            seed = std::strtoul(argv[i + 1], nullptr, 10);
+        } else {
+            std::cerr << "usage: " << argv[0] << " [--nodes N] [--model tiers|window|uniform] [--seed S]" << std::endl;
+            return 2;
+        }
+    }
+
+    for(const std::string &model : models) {
+        if(model != "tiers" && model != "window" && model != "uniform") {
+            std::cerr << model << ": unknown model" << std::endl;
+            return 2;
+        }
+
+        BenchGraph graph;
+        std::vector<std::shared_ptr<BenchNode> > nodes;
+        generate(graph, nodes, model, count, seed);
+
+        auto start = std::chrono::steady_clock::now();
+        LayeredGraphManager<int, bool, true, PlainNode> layout(graph, 1000, 1000, 10);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << model << ": " << count << " nodes, " << graph.edgeRange().size() << " edges, "
+                  << layout.getLayerCount() << " layers, " << layout.getDummyVertexCount() << " dummy vertices, "
+                  << layout.getCrossings() << " crossings, " << seconds << " s" << std::endl;
+    }
+    return 0;
+}
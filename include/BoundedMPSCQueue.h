@@ -0,0 +1,108 @@
+/******************************************
+ * A bounded, lock-free multi producer single
+ * consumer queue (after Dmitry Vyukov's bounded
+ * queue). Every cell carries a sequence number
+ * that tells producers and the consumer whose
+ * turn it is, so neither side ever blocks.
+ */
+
+#ifndef BOUNDEDMPSCQUEUE_H
+#define BOUNDEDMPSCQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+template<typename T>
+class BoundedMPSCQueue
+{
+    public:
+        /** \brief Constructor
+         * \param capacity size_t the maximum number of queued elements; rounded up to a power of two
+         */
+        explicit BoundedMPSCQueue(size_t capacity)
+        {
+            size_t size = 2;
+            while(size < capacity) size <<= 1;
+            mask = size - 1;
+
+            cells.reset(new Cell[size]);
+            for(size_t i = 0; i < size; ++i) {
+                cells[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        BoundedMPSCQueue(const BoundedMPSCQueue&) = delete;
+        BoundedMPSCQueue &operator=(const BoundedMPSCQueue&) = delete;
+
+        /** \brief Append an element; may be called from any number of threads.
+         * \param value the element; only moved from if the push succeeds
+         * \return bool true if the element was queued, false if the queue is full
+         */
+        bool tryPush(T &&value)
+        {
+            Cell *cell;
+            size_t position = enqueuePosition.load(std::memory_order_relaxed);
+            while(true) {
+                cell = &cells[position & mask];
+                size_t sequence = cell->sequence.load(std::memory_order_acquire);
+                intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+                if(difference == 0) {
+                    // the cell is free; claim it unless another producer was faster
+                    if(enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) break;
+                } else if(difference < 0) {
+                    return false;
+                } else {
+                    position = enqueuePosition.load(std::memory_order_relaxed);
+                }
+            }
+
+            cell->value = std::move(value);
+            cell->sequence.store(position + 1, std::memory_order_release);
+            return true;
+        }
+
+        /** \brief Take the oldest element; must only be called from the consumer thread.
+         * \param value receives the element
+         * \return bool true if an element was taken, false if the queue is empty
+         */
+        bool tryPop(T &value)
+        {
+            Cell &cell = cells[dequeuePosition & mask];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            if(static_cast<intptr_t>(sequence) - static_cast<intptr_t>(dequeuePosition + 1) < 0) return false;
+
+            value = std::move(cell.value);
+            // hand the cell back to the producers for the next round
+            cell.sequence.store(dequeuePosition + mask + 1, std::memory_order_release);
+            ++dequeuePosition;
+            return true;
+        }
+
+        /** \brief get the capacity of the queue.
+         * \return the maximum number of queued elements.
+         */
+        size_t capacity() const
+        {
+            return mask + 1;
+        }
+
+    private:
+        struct Cell {
+            std::atomic<size_t> sequence;
+            T value;
+        };
+
+        // keep the producer and consumer positions on separate cache lines
+        static const size_t CACHE_LINE = 64;
+
+        std::unique_ptr<Cell[]> cells;
+        size_t mask;
+        char producerPadding[CACHE_LINE];
+        std::atomic<size_t> enqueuePosition{0};
+        char consumerPadding[CACHE_LINE];
+        size_t dequeuePosition = 0;
+};
+
+#endif // BOUNDEDMPSCQUEUE_H
@@ -4,10 +4,18 @@
 #include <armadillo>
 #include <memory>
 #include <cmath>
-#include <map>
 #include <random>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <limits>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 #include "../Graph.hpp"
 #include "ArmadilloUtils.hpp"
+#include "SpatialHashGrid.h"
 
 /** \brief This class handles the automated expansion of nodes until they
  * reach a predefined distance between each other. Useful for graphical
@@ -36,62 +44,218 @@ class ExpandingGraphManager
             WIDTH(WIDTH),
             HEIGHT(HEIGHT),
             DEPTH(WIDTH),
-            RADIUS(RADIUS)
+            RADIUS(RADIUS),
+            overlapGrid(std::max(1u, 2 * RADIUS))
         {
 
-            if(graph.getNodes().size() == 0) return;
+            if(graph.nodeRange().empty()) return;
 
 
             positionNodes();
         }
 
+        /** \brief Destructor; abandons pending multi-start runs.
+         */
+        ~ExpandingGraphManager()
+        {
+            cancelLayouts = true;
+            if(layoutThread.joinable()) layoutThread.join();
+        }
+
+        /** \brief Progress of a time bounded update(), see update(std::chrono::steady_clock::duration).
+         */
+        struct UpdateProgress {
+            size_t processed = 0;         // the number of nodes updated by the call
+            bool sweepCompleted = false;  // true if the call updated the last node of a sweep over all nodes
+            double maxDisplacement = 0;   // the largest x/y movement of a node in the current sweep so far
+        };
+
         /** \brief Update the positions of all nodes. The update of the position is just a small change
          * which is useful for animations; however, this function must be called many times to get the
          * optimal result.
+         * \return double the largest distance a node was moved in the x/y (screen) plane; a layout
+         * has converged once this stays below a small threshold.
          */
-        void update()
+        double update()
         {
+            auto nodes = graph.nodeRange();
+            moveX.assign(nodes.size(), 0);
+            moveY.assign(nodes.size(), 0);
+            for(size_t i = 0; i < nodes.size(); ++i) {
+                updateNode(nodes[i], i);
+            }
 
-            for(auto node : graph.getNodes()) {
-
-                std::map<std::shared_ptr<NODE>, double> distancesToCurNode = getDistancesToNode(node);
+            return finishSweep();
+        }
 
-                arma::vec deltaVec = {0, 0, 0};
+        /** \brief Update the positions of as many nodes as fit into a time budget. The nodes are
+         * updated round-robin: every call resumes where the last one stopped, and the nodes not
+         * reached yet keep their positions of the last sweep. A sweep over all nodes therefore moves
+         * the nodes like one update() does, but can be spread over several frames, so the time of a
+         * frame doesn't grow with the graph. At least one node is updated per call; the overlap sweep
+         * (if enabled) runs once at the end of every sweep.
+         * \param budget the time the call may take
+         * \return UpdateProgress the number of updated nodes and whether a sweep has been completed
+         */
+        UpdateProgress update(std::chrono::steady_clock::duration budget)
+        {
+            auto deadline = std::chrono::steady_clock::now() + budget;
+            UpdateProgress progress;
+            auto nodes = graph.nodeRange();
+            if(sweepCursor == 0) {
+                moveX.assign(nodes.size(), 0);
+                moveY.assign(nodes.size(), 0);
+            }
 
-                // rejection
-                for(auto nodeDistancePair : distancesToCurNode) {
-                    arma::vec directionVec = calculateDirectionVectorFromTo(nodeDistancePair.first, node);
+            do {
+                // nodes may have been removed since the last call
+                if(sweepCursor >= nodes.size()) {
+                    progress.sweepCompleted = true;
+                    break;
+                }
+                // nodes may have been added since the sweep started
+                if(sweepCursor >= moveX.size()) {
+                    moveX.resize(nodes.size(), 0);
+                    moveY.resize(nodes.size(), 0);
+                }
+                sweepDisplacement = std::max(sweepDisplacement, updateNode(nodes[sweepCursor], sweepCursor));
+                ++sweepCursor;
+                ++progress.processed;
+            } while(std::chrono::steady_clock::now() < deadline);
+            if(sweepCursor >= nodes.size()) progress.sweepCompleted = true;
+
+            if(progress.sweepCompleted) {
+                progress.maxDisplacement = finishSweep();
+                sweepCursor = 0;
+                sweepDisplacement = 0;
+            } else {
+                progress.maxDisplacement = sweepDisplacement;
+            }
+            return progress;
+        }
 
-                    // prevent division by 0 just in case
-                    if(nodeDistancePair.second == 0) continue;
+        /** \brief Enable or disable the incremental overlap removal. If enabled, every update()
+         * ends with one sweep that pushes apart nodes whose sprites overlap. The sweep works against
+         * the attraction of adjacent nodes, so the settled layout may still have small overlaps and a
+         * few layouts keep oscillating; call removeOverlaps() once the layout has settled instead
+         * where no overlap must remain.
+         * \param enabled true to remove overlaps during update(), else false
+         */
+        void setOverlapRemoval(bool enabled) {
+            overlapRemoval = enabled;
+        }
 
-                    deltaVec += (std::pow(rejectionFactor, 2)/nodeDistancePair.second) * directionVec;
+        /** \brief Push apart overlapping nodes until no two nodes are closer than twice the radius
+         * in the x/y (screen) plane. Useful as final pass once the layout has settled.
+         * \param maxSweeps unsigned the maximum number of sweeps over all nodes
+         * \return bool true if all overlaps have been removed, else false
+         */
+        bool removeOverlaps(unsigned maxSweeps = 500) {
+            for(unsigned sweep = 0; sweep < maxSweeps; ++sweep) {
+                if(separateOverlappingNodes() == 0) return true;
+            }
+            return false;
+        }
 
+        /** \brief removeOverlaps() spread over several frames: runs sweeps until no overlaps remain or
+         * the budget is used up, at least one per call. The sweeps of consecutive calls are counted
+         * together, so the removal still ends after maxSweeps sweeps; update() starts a new count.
+         * \param budget the time the call may take
+         * \param maxSweeps unsigned the maximum number of sweeps of the whole removal
+         * \return bool true if the removal is done (no overlaps remain or maxSweeps sweeps have been
+         * run), false if it has to be continued by another call
+         */
+        bool removeOverlaps(std::chrono::steady_clock::duration budget, unsigned maxSweeps = 500) {
+            auto deadline = std::chrono::steady_clock::now() + budget;
+            do {
+                if(overlapSweeps >= maxSweeps || separateOverlappingNodes() == 0) {
+                    overlapSweeps = 0;
+                    return true;
                 }
+                ++overlapSweeps;
+            } while(std::chrono::steady_clock::now() < deadline);
+            return false;
+        }
 
+        /** \brief Lay out the graph several times from different random start positions at once and
+         * adopt the best layout, instead of the single random start of the constructor. Every run
+         * iterates the force model of update() on its own copy of the positions, so the runs don't
+         * share any state except the energy checkpoints: every CHECKPOINT_INTERVAL iterations a run
+         * compares its energy with the best energy any run had at that point and gives up if it is
+         * clearly worse. The finished runs are scored by their energy and their number of edge
+         * crossings on screen; both are normalised over the finished runs and weighted by the
+         * crossing weight. Blocks until all runs are done; see startMultiStart() for interactive use.
+         * \param runs unsigned the number of layouts; 0 for one per core
+         * \param maxIterations unsigned the maximum number of iterations of a run
+         * \param epsilon double a run has converged once no node moves further in an iteration
+         * \return unsigned the number of runs that were finished, i.e. not abandoned
+         */
+        unsigned multiStart(unsigned runs = 0, unsigned maxIterations = 2000, double epsilon = 0.05) {
+            if(layoutThread.joinable() || !prepareLayouts()) return 0;
 
-                //attraction
-                for(auto adjPrimitiveNode : node->getAdjacentNodes()) {
-                    // cast needed because nodes just save Node-class pointer for adjacent nodes
-                    std::shared_ptr<NODE> adjNode = std::dynamic_pointer_cast<NODE>(adjPrimitiveNode);
-                    arma::vec directionVec = calculateDirectionVectorFromTo(node, adjNode);
-
+            unsigned finished = runLayouts(runs, maxIterations, epsilon);
+            adoptBestLayout();
+            return finished;
+        }
 
-                    deltaVec += std::pow(distancesToCurNode[adjNode], 0.5) * directionVec;
+        /** \brief multiStart() on a worker thread, so the view doesn't freeze for the whole runs. The
+         * graph is indexed on the calling thread; the runs only work on their own position arrays, so
+         * the graph may be updated and mutated meanwhile. Call adoptMultiStart() between two frames to
+         * take over the result.
+         * \param onFinished called on the worker thread once the runs are done, e.g. to wake the main loop
+         * \param runs unsigned the number of layouts; 0 for one per core
+         * \param maxIterations unsigned the maximum number of iterations of a run
+         * \param epsilon double a run has converged once no node moves further in an iteration
+         * \return bool true if the runs were started, false if the graph is empty or runs are still pending
+         */
+        bool startMultiStart(std::function<void()> onFinished = nullptr, unsigned runs = 0, unsigned maxIterations = 2000,
+                             double epsilon = 0.05) {
+            if(layoutThread.joinable() || !prepareLayouts()) return false;
+
+            layoutsDone = false;
+            layoutThread = std::thread([this, onFinished, runs, maxIterations, epsilon] {
+                finishedLayouts = runLayouts(runs, maxIterations, epsilon);
+                layoutsDone = true;
+                if(onFinished && !cancelLayouts) onFinished();
+            });
+            return true;
+        }
 
-                    // if the graph is directed, we have to implement the reversed attraction
-                    // manually.
-                    if(isDirected == true) {
-                        arma::vec newPos = adjNode->getPosition() + std::pow(distancesToCurNode[adjNode], 0.5) * directionVec;
-                        adjNode->setPosition(newPos);
-                    }
-                }
+        /** \brief check if runs started by startMultiStart() haven't been adopted yet.
+         * \return true if runs are pending, else false.
+         */
+        bool isMultiStartPending() const {
+            return layoutThread.joinable();
+        }
 
-                node->setPosition(deltaVec + node->getPosition());
+        /** \brief Take over the best layout of startMultiStart() if its runs are done. Nodes added
+         * since the start keep their positions, removed ones are skipped.
+         * \return unsigned the number of finished runs if a layout was adopted; 0 if the runs are
+         * still going on, none are pending or all were abandoned
+         */
+        unsigned adoptMultiStart() {
+            if(!layoutThread.joinable() || !layoutsDone) return 0;
 
+            layoutThread.join();
+            if(finishedLayouts > 0) adoptBestLayout();
+            return finishedLayouts;
+        }
 
-            }
+        /** \brief set how much the edge crossings count when multiStart() picks a layout.
+         * \param weight double between 0 (energy only) and 1 (crossings only)
+         */
+        void setCrossingWeight(double weight) {
+            crossingWeight = std::min(1.0, std::max(0.0, weight));
+        }
 
+        /** \brief Give a node that was added to the graph after construction a random
+         * start position around the center, like all nodes get initially.
+         * \param node Node<T>& the new node
+         */
+        void placeNode(NODE &node) {
+            node.setPosition(getRandomBetween(WIDTH / 2 - 100, WIDTH / 2 + 100),
+                             getRandomBetween(HEIGHT / 2 - 100, HEIGHT / 2 + 100),
+                             getRandomBetween(DEPTH / 2 - 100, DEPTH / 2 + 100));
         }
 
         /** \brief adjust the attraction factor for all nodes
@@ -105,14 +269,14 @@ class ExpandingGraphManager
          * \param degree the degree the graph should be turned
          */
         void turnGraphYForDegree(double degree) {
-            for(auto node : graph.getNodes()) {
-                arma::vec posVec = node->getPosition();
+            for(NODE &node : graph.nodeRange()) {
+                arma::vec posVec = node.getPosition();
                 posVec.at(0) -= WIDTH / 2;
                 posVec.at(2) -= DEPTH / 2;
                 posVec = ArmaUtils::turnVectorYDegree(posVec, degree);
                 posVec.at(0) += WIDTH / 2;
                 posVec.at(2) += DEPTH / 2;
-                node->setPosition(posVec);
+                node.setPosition(posVec);
             }
         }
 
@@ -121,14 +285,14 @@ class ExpandingGraphManager
          * \param degree the degree the graph should be turned
          */
         void turnGraphXForDegree(double degree) {
-            for(auto node : graph.getNodes()) {
-                arma::vec posVec = node->getPosition();
+            for(NODE &node : graph.nodeRange()) {
+                arma::vec posVec = node.getPosition();
                 posVec.at(1) -= WIDTH / 2;
                 posVec.at(2) -= DEPTH / 2;
                 posVec = ArmaUtils::turnVectorXDegree(posVec, degree);
                 posVec.at(1) += WIDTH / 2;
                 posVec.at(2) += DEPTH / 2;
-                node->setPosition(posVec);
+                node.setPosition(posVec);
             }
         }
 
@@ -140,6 +304,44 @@ class ExpandingGraphManager
         const unsigned WIDTH, HEIGHT, DEPTH, RADIUS; // depth is currently set to width; can be changed if needed
         double rejectionFactor = 10.0;
 
+        // position of the next node of a time bounded update() and the largest movement of its sweep
+        size_t sweepCursor = 0;
+        double sweepDisplacement = 0;
+        // the x/y movement of every node by the forces in the current sweep
+        std::vector<double> moveX, moveY;
+
+        // overlap removal; the buffers are members so the sweeps don't allocate
+        bool overlapRemoval = false;
+        unsigned overlapSweeps = 0; // sweeps of the time bounded removeOverlaps() so far
+        static constexpr double OVERLAP_MARGIN = 1.05;
+        SpatialHashGrid overlapGrid;
+        std::vector<NODE*> overlapNodes;
+        std::vector<double> overlapX, overlapY, shiftX, shiftY;
+
+        // multi-start; the graph is indexed once, so the runs can work on plain position arrays
+        struct LayoutRun {
+            std::vector<double> positions; // x, y, z of every node
+            double energy = 0;
+            unsigned long crossings = 0;
+            bool abandoned = false;
+        };
+        static const unsigned CHECKPOINT_INTERVAL = 50;
+        // after the first ABANDON_WARMUP checkpoints, a run is abandoned if its energy is worse than the
+        // best one at a checkpoint by more than this fraction of the descent from its start energy
+        static const unsigned ABANDON_WARMUP = 4;
+        static constexpr double ABANDON_MARGIN = 0.03;
+        double crossingWeight = 0.5;
+        std::vector<NODE*> layoutNodes;
+        std::vector<unsigned> adjacencyOffsets, adjacency;
+        std::vector<std::pair<unsigned, unsigned> > layoutEdges;
+        std::unique_ptr<std::atomic<double>[]> checkpointEnergies;
+        // the parameters are copied when the runs start, so the main thread may change them meanwhile
+        double layoutRejectionFactor = 0, layoutCrossingWeight = 0;
+        std::vector<double> bestPositions; // of layoutNodes, written by the runs
+        unsigned finishedLayouts = 0;
+        std::atomic<bool> layoutsDone{false}, cancelLayouts{false};
+        std::thread layoutThread; // of startMultiStart(); uses all of the above
+
         /** \brief Get a random value including both sides of the given range.
          *
          * \param x int lower value
@@ -158,13 +360,13 @@ class ExpandingGraphManager
 
         /** \brief Get the euclidean distance between two nodes.
          *
-         * \param node1 Node<T>* a pointer to the first node
-         * \param node2 Node<T>* a pointer to the second node
+         * \param node1 Node<T>& the first node
+         * \param node2 Node<T>& the second node
          * \return unsigned the distance between the two nodes
          *
          */
-        double getDistance(std::shared_ptr<NODE> node1, std::shared_ptr<NODE> node2) {
-            arma::vec directionVec = node2->getPosition() - node1->getPosition();
+        double getDistance(const NODE &node1, const NODE &node2) {
+            arma::vec directionVec = node2.getPosition() - node1.getPosition();
 
             // euclidean distance
             return ArmaUtils::getLength(directionVec);
@@ -173,41 +375,407 @@ class ExpandingGraphManager
 
         /** \brief Get a normalized direction vector between two given nodes.
          *
-         * \param node1 Node<T>* the starting node
-         * \param node2 Node<T>* the end node
+         * \param node1 Node<T>& the starting node
+         * \param node2 Node<T>& the end node
          * \return std::pair<double, double> a 2D-vector (pair) containing the normalized direction vector.
          *
          */
-        arma::vec calculateDirectionVectorFromTo(std::shared_ptr<NODE> node1, std::shared_ptr<NODE> node2) {
-            return arma::normalise(node2->getPosition() - node1->getPosition());
+        arma::vec calculateDirectionVectorFromTo(const NODE &node1, const NODE &node2) {
+            return arma::normalise(node2.getPosition() - node1.getPosition());
         }
 
 
-        /** \brief Get a map containing the distances between a given node and all other nodes.
-         * The given Node is not included in the returned distance map.
-         * \param node Node<T>* a pointer to the node from which all distances should calculated
-         * \return std::map<Node<T>*, unsigned> a map with pointers to all other nodes as index and the distance
-         *  as value.
+        /** \brief One sweep of the overlap removal (in the style of force scan algorithms): every pair
+         * of nodes closer than twice the radius in the x/y plane is pushed apart along its connecting
+         * line, each node by half of the overlap. Close pairs are found with a spatial hash grid whose
+         * cells are as large as the minimum distance, so the sweep is O(n) on average. The shifts are
+         * accumulated first and applied afterwards, so the result does not depend on the node order.
+         * \return double the largest shift of a node; 0 if no nodes overlap
          */
-        std::map<std::shared_ptr<NODE>, double> getDistancesToNode(std::shared_ptr<NODE> node) {
-            std::map<std::shared_ptr<NODE>, double> distances;
-            for(std::shared_ptr<NODE> curNode : graph.getNodes()) {
-                if(node == curNode) continue;
-                distances[curNode] = getDistance(node, curNode);
+        double separateOverlappingNodes() {
+            const double minDistance = 2.0 * RADIUS;
+            if(minDistance == 0) return 0;
+
+            overlapNodes.clear();
+            overlapX.clear();
+            overlapY.clear();
+            for(NODE &node : graph.nodeRange()) {
+                overlapNodes.push_back(&node);
+                overlapX.push_back(node.getPosition().at(0));
+                overlapY.push_back(node.getPosition().at(1));
+            }
+            shiftX.assign(overlapNodes.size(), 0);
+            shiftY.assign(overlapNodes.size(), 0);
+
+            overlapGrid.reset(overlapNodes.size());
+            for(size_t i = 0; i < overlapNodes.size(); ++i) {
+                overlapGrid.insert(i, overlapX[i], overlapY[i]);
+            }
+
+            bool overlapping = false;
+            for(size_t i = 0; i < overlapNodes.size(); ++i) {
+                overlapGrid.forEachNear(overlapX[i], overlapY[i], [&](size_t j) {
+                    // handle every pair once
+                    if(j <= i) return;
+
+                    double dx = overlapX[j] - overlapX[i], dy = overlapY[j] - overlapY[i];
+                    double distance = std::hypot(dx, dy);
+                    if(distance >= minDistance) return;
+
+                    // nodes on top of each other have no direction; pick a deterministic one
+                    if(distance == 0) {
+                        double angle = static_cast<double>(i + j);
+                        dx = std::cos(angle);
+                        dy = std::sin(angle);
+                        distance = 1;
+                    }
+
+                    // each node takes half of the overlap; the target distance has a small margin
+                    // so nodes jammed between others don't only creep towards the minimum distance
+                    double push = 0.5 * (OVERLAP_MARGIN * minDistance - distance) / distance;
+                    shiftX[i] -= push * dx;
+                    shiftY[i] -= push * dy;
+                    shiftX[j] += push * dx;
+                    shiftY[j] += push * dy;
+                    overlapping = true;
+                });
             }
-            return distances;
+            if(!overlapping) return 0;
+
+            double maxShift = 0;
+            for(size_t i = 0; i < overlapNodes.size(); ++i) {
+                if(shiftX[i] == 0 && shiftY[i] == 0) continue;
+
+                arma::vec position = overlapNodes[i]->getPosition();
+                position.at(0) += shiftX[i];
+                position.at(1) += shiftY[i];
+                overlapNodes[i]->setPosition(position);
+                maxShift = std::max(maxShift, std::hypot(shiftX[i], shiftY[i]));
+            }
+            return maxShift;
         }
 
 
+        /** \brief Move a node by the rejection of all other nodes and the attraction of its adjacent nodes.
+         * \param node Node<T>& the node to move
+         * \param index size_t the position of the node in the graph; its movement is stored there
+         * \return double the distance the node was moved in the x/y (screen) plane
+         */
+        double updateNode(NODE &node, size_t index)
+        {
+            arma::vec deltaVec = {0, 0, 0};
+
+            // rejection
+            for(NODE &curNode : graph.nodeRange()) {
+                if(&node == &curNode) continue;
+
+                double distance = getDistance(node, curNode);
+
+                // prevent division by 0 just in case
+                if(distance == 0) continue;
+
+                arma::vec directionVec = calculateDirectionVectorFromTo(curNode, node);
+                deltaVec += (std::pow(rejectionFactor, 2)/distance) * directionVec;
+
+            }
+
+
+            //attraction
+            for(NODE &adjNode : graph.adjacentNodes(node)) {
+                double distance = getDistance(node, adjNode);
+                arma::vec directionVec = calculateDirectionVectorFromTo(node, adjNode);
+
+
+                deltaVec += std::pow(distance, 0.5) * directionVec;
+
+                // if the graph is directed, we have to implement the reversed attraction
+                // manually.
+                if(isDirected == true) {
+                    arma::vec newPos = adjNode.getPosition() + std::pow(distance, 0.5) * directionVec;
+                    adjNode.setPosition(newPos);
+                }
+            }
+
+            node.setPosition(deltaVec + node.getPosition());
+            moveX[index] = deltaVec.at(0);
+            moveY[index] = deltaVec.at(1);
+            return std::hypot(deltaVec.at(0), deltaVec.at(1));
+        }
+
+        /** \brief End a sweep over all nodes: run the overlap sweep if enabled and get the largest
+         * net movement of a node, i.e. the movement by the forces plus the overlap shift. Where the
+         * shift just undoes the forces the node doesn't move, so the layout can still settle.
+         * \return double the largest net distance a node was moved in the x/y (screen) plane
+         */
+        double finishSweep()
+        {
+            overlapSweeps = 0;
+            bool shifted = overlapRemoval && separateOverlappingNodes() > 0;
+            size_t count = std::min(moveX.size(), overlapNodes.size());
+
+            double maxDisplacement = 0;
+            for(size_t i = 0; i < moveX.size(); ++i) {
+                double dx = moveX[i], dy = moveY[i];
+                if(shifted && i < count) {
+                    dx += shiftX[i];
+                    dy += shiftY[i];
+                }
+                maxDisplacement = std::max(maxDisplacement, std::hypot(dx, dy));
+            }
+            return maxDisplacement;
+        }
+
+        /** \brief Number the nodes and store the adjacency and the edges by these numbers.
+         */
+        void buildLayoutIndex() {
+            layoutNodes.clear();
+            std::unordered_map<const NODE*, unsigned> indices;
+            for(NODE &node : graph.nodeRange()) {
+                indices[&node] = layoutNodes.size();
+                layoutNodes.push_back(&node);
+            }
+
+            adjacencyOffsets.assign(1, 0);
+            adjacency.clear();
+            for(NODE *node : layoutNodes) {
+                for(NODE &adjNode : graph.adjacentNodes(*node)) {
+                    auto adjIt = indices.find(&adjNode);
+                    if(adjIt != indices.end()) adjacency.push_back(adjIt->second);
+                }
+                adjacencyOffsets.push_back(adjacency.size());
+            }
+
+            layoutEdges.clear();
+            for(EDGE &edge : graph.edgeRange()) {
+                auto firstIt = indices.find(edge.getFirstNode().get()), secondIt = indices.find(edge.getSecondNode().get());
+                if(firstIt != indices.end() && secondIt != indices.end() && firstIt->second != secondIt->second) {
+                    layoutEdges.emplace_back(firstIt->second, secondIt->second);
+                }
+            }
+        }
+
+        /** \brief Index the graph and copy the layout parameters for multi-start runs.
+         * \return bool true if there is anything to lay out, else false
+         */
+        bool prepareLayouts() {
+            buildLayoutIndex();
+            layoutRejectionFactor = rejectionFactor;
+            layoutCrossingWeight = crossingWeight;
+            return !layoutNodes.empty();
+        }
+
+        /** \brief Do the runs of multiStart() on threads of their own and keep the positions of the best
+         * run in bestPositions. Only uses the layout index, so it may run on a worker thread.
+         * \return unsigned the number of runs that were finished, i.e. not abandoned
+         */
+        unsigned runLayouts(unsigned runs, unsigned maxIterations, double epsilon) {
+            if(runs == 0) runs = std::max(1u, std::thread::hardware_concurrency());
+
+            size_t checkpoints = maxIterations / CHECKPOINT_INTERVAL + 1;
+            checkpointEnergies.reset(new std::atomic<double>[checkpoints]);
+            for(size_t checkpoint = 0; checkpoint < checkpoints; ++checkpoint) {
+                checkpointEnergies[checkpoint] = std::numeric_limits<double>::max();
+            }
+
+            std::vector<LayoutRun> layoutRuns(runs);
+            std::vector<std::thread> threads;
+            unsigned seed = std::random_device()();
+            for(unsigned run = 0; run < runs; ++run) {
+                threads.emplace_back(&ExpandingGraphManager::runLayout, this, std::ref(layoutRuns[run]),
+                                     seed + run, maxIterations, epsilon);
+            }
+            for(std::thread &thread : threads) {
+                thread.join();
+            }
+
+            // normalise energy and crossings over the finished runs, so the weight is independent of the graph
+            double minEnergy = std::numeric_limits<double>::max(), maxEnergy = std::numeric_limits<double>::lowest();
+            unsigned long minCrossings = std::numeric_limits<unsigned long>::max(), maxCrossings = 0;
+            unsigned finished = 0;
+            for(LayoutRun &run : layoutRuns) {
+                if(run.abandoned) continue;
+                ++finished;
+                minEnergy = std::min(minEnergy, run.energy);
+                maxEnergy = std::max(maxEnergy, run.energy);
+                minCrossings = std::min(minCrossings, run.crossings);
+                maxCrossings = std::max(maxCrossings, run.crossings);
+            }
+
+            LayoutRun *best = nullptr;
+            double bestScore = std::numeric_limits<double>::max();
+            for(LayoutRun &run : layoutRuns) {
+                if(run.abandoned) continue;
+                double energyScore = maxEnergy > minEnergy ? (run.energy - minEnergy) / (maxEnergy - minEnergy) : 0;
+                double crossingScore = maxCrossings > minCrossings ? double(run.crossings - minCrossings) / (maxCrossings - minCrossings) : 0;
+                double score = (1 - layoutCrossingWeight) * energyScore + layoutCrossingWeight * crossingScore;
+                if(score < bestScore) {
+                    bestScore = score;
+                    best = &run;
+                }
+            }
+
+            if(best == nullptr) return 0;
+            bestPositions.swap(best->positions);
+            return finished;
+        }
+
+        /** \brief Move the nodes to bestPositions. The nodes are matched by address, as nodes may have
+         * been added to or removed from the graph while the runs were going on.
+         */
+        void adoptBestLayout() {
+            std::unordered_map<const NODE*, size_t> indices;
+            for(size_t i = 0; i < layoutNodes.size(); ++i) {
+                indices[layoutNodes[i]] = i;
+            }
+            for(NODE &node : graph.nodeRange()) {
+                auto it = indices.find(&node);
+                if(it == indices.end()) continue;
+                size_t i = it->second;
+                node.setPosition(bestPositions[3 * i], bestPositions[3 * i + 1], bestPositions[3 * i + 2]);
+            }
+        }
+
+        /** \brief One multi-start run: a random start like positionNodes(), then the iterations of update().
+         * Runs on its own thread; it only reads the layout index and writes its own LayoutRun.
+         */
+        void runLayout(LayoutRun &run, unsigned seed, unsigned maxIterations, double epsilon) {
+            std::mt19937 rng(seed);
+            std::uniform_int_distribution<int> distX(WIDTH / 2 - 100, WIDTH / 2 + 100), distY(HEIGHT / 2 - 100, HEIGHT / 2 + 100),
+                                               distZ(DEPTH / 2 - 100, DEPTH / 2 + 100);
+            std::vector<double> &p = run.positions;
+            p.resize(3 * layoutNodes.size());
+            for(size_t i = 0; i < layoutNodes.size(); ++i) {
+                p[3 * i] = distX(rng);
+                p[3 * i + 1] = distY(rng);
+                p[3 * i + 2] = distZ(rng);
+            }
+
+            // a run is judged by its descent so far, the energy of a layout itself has no scale
+            double startEnergy = layoutEnergy(p);
+            for(unsigned iteration = 1; iteration <= maxIterations; ++iteration) {
+                if(cancelLayouts) {
+                    run.abandoned = true;
+                    return;
+                }
+                bool converged = iterateLayout(p) <= epsilon;
+
+                if(iteration % CHECKPOINT_INTERVAL != 0 && !converged) continue;
+                double energy = layoutEnergy(p);
+                size_t checkpoint = iteration / CHECKPOINT_INTERVAL;
+                if(converged) {
+                    // a settled layout stays as it is, so it also sets the bar for all later checkpoints
+                    size_t checkpoints = maxIterations / CHECKPOINT_INTERVAL + 1;
+                    for(size_t later = checkpoint; later < checkpoints; ++later) lowerCheckpointEnergy(later, energy);
+                    break;
+                }
+                double best = lowerCheckpointEnergy(checkpoint, energy);
+                if(checkpoint >= ABANDON_WARMUP && energy - best > ABANDON_MARGIN * (startEnergy - best)) {
+                    run.abandoned = true;
+                    return;
+                }
+            }
+
+            run.energy = layoutEnergy(p);
+            run.crossings = countCrossings(p);
+        }
+
+        /** \brief Lower the best energy of a checkpoint.
+         * \return double the best energy of the checkpoint, including the given one
+         */
+        double lowerCheckpointEnergy(size_t checkpoint, double energy) {
+            double best = checkpointEnergies[checkpoint].load();
+            while(energy < best && !checkpointEnergies[checkpoint].compare_exchange_weak(best, energy)) {}
+            return std::min(best, energy);
+        }
+
+        /** \brief update() on a position array.
+         * \return double the largest distance a node was moved in the x/y plane
+         */
+        double iterateLayout(std::vector<double> &p) {
+            double maxDisplacement = 0;
+            const double rejection = layoutRejectionFactor * layoutRejectionFactor;
+
+            for(unsigned i = 0; i < layoutNodes.size(); ++i) {
+                double delta[3] = {0, 0, 0};
+
+                // rejection
+                for(unsigned j = 0; j < layoutNodes.size(); ++j) {
+                    if(i == j) continue;
+                    double d[3] = { p[3 * i] - p[3 * j], p[3 * i + 1] - p[3 * j + 1], p[3 * i + 2] - p[3 * j + 2] };
+                    double distance = std::sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+                    if(distance == 0) continue;
+                    for(int k = 0; k < 3; ++k) delta[k] += rejection / distance * d[k] / distance;
+                }
+
+                // attraction
+                for(unsigned a = adjacencyOffsets[i]; a < adjacencyOffsets[i + 1]; ++a) {
+                    unsigned j = adjacency[a];
+                    double d[3] = { p[3 * j] - p[3 * i], p[3 * j + 1] - p[3 * i + 1], p[3 * j + 2] - p[3 * i + 2] };
+                    double distance = std::sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+                    if(distance == 0) continue;
+                    for(int k = 0; k < 3; ++k) {
+                        delta[k] += std::sqrt(distance) * d[k] / distance;
+                        if(isDirected == true) p[3 * j + k] += std::sqrt(distance) * d[k] / distance;
+                    }
+                }
+
+                for(int k = 0; k < 3; ++k) p[3 * i + k] += delta[k];
+                maxDisplacement = std::max(maxDisplacement, std::hypot(delta[0], delta[1]));
+            }
+            return maxDisplacement;
+        }
+
+        /** \brief Get the energy whose gradient are the forces of update(): the attraction sqrt(d)
+         * integrates to 2/3 d^1.5 per edge, the rejection r^2/d to -r^2 ln(d) per pair of nodes.
+         */
+        double layoutEnergy(const std::vector<double> &p) const {
+            auto distance = [&p](unsigned i, unsigned j) {
+                return std::sqrt(std::pow(p[3 * i] - p[3 * j], 2) + std::pow(p[3 * i + 1] - p[3 * j + 1], 2) + std::pow(p[3 * i + 2] - p[3 * j + 2], 2));
+            };
+
+            double energy = 0;
+            for(auto &edge : layoutEdges) {
+                energy += 2.0 / 3.0 * std::pow(distance(edge.first, edge.second), 1.5);
+            }
+            const double rejection = layoutRejectionFactor * layoutRejectionFactor;
+            for(unsigned i = 0; i < layoutNodes.size(); ++i) {
+                for(unsigned j = i + 1; j < layoutNodes.size(); ++j) {
+                    double d = distance(i, j);
+                    // nodes on top of each other are a bad layout, not an infinitely good one
+                    energy -= rejection * std::log(std::max(d, 1.0));
+                }
+            }
+            return energy;
+        }
+
+        /** \brief Count the pairs of edges that cross on screen, i.e. in the x/y plane.
+         * Edges sharing a node don't count.
+         */
+        unsigned long countCrossings(const std::vector<double> &p) const {
+            auto orientation = [&p](unsigned a, unsigned b, unsigned c) {
+                double cross = (p[3 * b] - p[3 * a]) * (p[3 * c + 1] - p[3 * a + 1]) - (p[3 * b + 1] - p[3 * a + 1]) * (p[3 * c] - p[3 * a]);
+                return (cross > 0) - (cross < 0);
+            };
+
+            unsigned long crossings = 0;
+            for(size_t e = 0; e < layoutEdges.size(); ++e) {
+                unsigned a = layoutEdges[e].first, b = layoutEdges[e].second;
+                for(size_t f = e + 1; f < layoutEdges.size(); ++f) {
+                    unsigned c = layoutEdges[f].first, d = layoutEdges[f].second;
+                    if(a == c || a == d || b == c || b == d) continue;
+                    if(orientation(a, b, c) * orientation(a, b, d) < 0 && orientation(c, d, a) * orientation(c, d, b) < 0) ++crossings;
+                }
+            }
+            return crossings;
+        }
+
         /** \brief Set the position of all nodes. Outgoing from a given node,
          * the positions of the child nodes are recursively are set.
          * \param node Node<T>* the starting node. The position of this node must be already set.
          */
         void positionNodes() {
-            for(std::shared_ptr<NODE> node : graph.getNodes()) {
-                node->setPosition(getRandomBetween(WIDTH / 2 - 100, WIDTH / 2 + 100),
-                                  getRandomBetween(HEIGHT / 2 - 100, HEIGHT / 2 + 100),
-                                  getRandomBetween(DEPTH / 2 - 100, DEPTH / 2 + 100));
+            for(NODE &node : graph.nodeRange()) {
+                placeNode(node);
             }
         }
 };
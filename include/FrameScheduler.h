@@ -0,0 +1,192 @@
+/******************************************
+ * A frame scheduler for the interactive view.
+ * It keeps track of what changed since the last
+ * frame, so the main loop can skip the simulation
+ * and the redraw and block instead of spinning
+ * once the layout has settled.
+ */
+
+#ifndef FRAMESCHEDULER_H
+#define FRAMESCHEDULER_H
+
+#include <SFML/Window.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+class FrameScheduler
+{
+    public:
+        /** \brief Constructor
+         * \param movementThreshold double the layout counts as settled once no node moves further
+         * than this many pixels in one update
+         * \param settleSweeps unsigned how many updates in a row must stay below the threshold, so a
+         * layout oscillating around the threshold doesn't count as settled
+         */
+        explicit FrameScheduler(double movementThreshold = 0.5, unsigned settleSweeps = 3)
+            : movementThreshold(movementThreshold), settleSweeps(settleSweeps) { };
+
+        /** \brief Record that an input event arrived. Resizing the window or getting the focus back
+         * may have invalidated the window content, so those events cause a redraw. Events don't resume
+         * the simulation: a settled layout would only drift back from its final overlap removal. Call
+         * notifyLayoutChanged() for the events that change layout parameters.
+         * \param event the event
+         */
+        void notifyEvent(const sf::Event &event) {
+            if(event.type == sf::Event::Resized || event.type == sf::Event::GainedFocus) redraw = true;
+        }
+
+        /** \brief Record that a parameter of the layout (e.g. the rejection factor) changed, so the
+         * simulation is resumed.
+         */
+        void notifyLayoutChanged() {
+            resume();
+        }
+
+        /** \brief Record that the camera (the rotation of the graph) changed. The forces only depend
+         * on the distances between the nodes, which a rotation keeps, so the simulation isn't resumed;
+         * but the nodes overlap differently on screen, so a settled layout gets a new final pass.
+         */
+        void notifyCameraChanged() {
+            finalPass = settled;
+            redraw = true;
+        }
+
+        /** \brief Record that nodes or edges were added or removed. May be called from any
+         * thread; wakes a main loop blocked in waitEvent().
+         */
+        void notifyGraphMutated() {
+            {
+                std::lock_guard<std::mutex> lock(wakeMutex);
+                graphMutated = true;
+            }
+            wakeup.notify_all();
+        }
+
+        /** \brief Start a frame; takes over the graph mutations recorded since the last frame.
+         */
+        void beginFrame() {
+            if(graphMutated.exchange(false)) {
+                resume();
+                redraw = true;
+            }
+        }
+
+        /** \brief Record the result of a simulation step. Movements below the threshold don't
+         * cause a redraw; once settleSweeps steps in a row stayed below it, the simulation stops.
+         * \param maxDisplacement double the largest distance a node moved, as returned by update()
+         */
+        void notifySimulated(double maxDisplacement) {
+            if(maxDisplacement < movementThreshold) {
+                settled = ++calmSweeps >= settleSweeps;
+                finalPass = settled;
+            } else {
+                calmSweeps = 0;
+                redraw = true;
+            }
+        }
+
+        /** \brief Record the result of a simulation step that only updated part of the nodes.
+         * The layout can't have settled before the sweep is complete, so only the redraw is affected.
+         * \param maxDisplacement double the largest distance a node moved so far in the sweep
+         */
+        void notifyPartiallySimulated(double maxDisplacement) {
+            if(maxDisplacement >= movementThreshold) redraw = true;
+        }
+
+        /** \brief Record the result of a part of the final pass (e.g. the overlap removal) that runs
+         * once the layout has settled. The pass moved nodes, so the view is redrawn.
+         * \param completed bool true if the pass is done, false if it continues in the next frame
+         */
+        void notifyFinalPass(bool completed) {
+            if(completed) finalPass = false;
+            redraw = true;
+        }
+
+        /** \brief check if the layout should be advanced this frame.
+         * \return true if the layout has not settled yet, else false.
+         */
+        bool needsSimulation() const {
+            return !settled;
+        }
+
+        /** \brief check if the final pass should be advanced this frame.
+         * \return true if the layout has settled and the final pass is not done yet, else false.
+         */
+        bool needsFinalPass() const {
+            return settled && finalPass;
+        }
+
+        /** \brief check if the window content is outdated.
+         * \return true if the graph has to be drawn this frame, else false.
+         */
+        bool needsRedraw() const {
+            return redraw;
+        }
+
+        /** \brief check if there is nothing to do until the next event or graph mutation.
+         * \return true if neither simulation, final pass nor redraw is needed, else false.
+         */
+        bool isIdle() const {
+            return settled && !finalPass && !redraw && !graphMutated;
+        }
+
+        /** \brief End a frame; must be called after the graph has been drawn.
+         */
+        void frameDone() {
+            redraw = false;
+        }
+
+        /** \brief Allow other threads to mutate the graph. sf::Window::waitEvent() cannot be
+         * interrupted, so while this is enabled waitEvent() polls the window in short slices
+         * and otherwise sleeps until notifyGraphMutated() is called.
+         * \param enabled true if other threads mutate the graph, else false
+         */
+        void setExternalMutations(bool enabled) {
+            externalMutations = enabled;
+        }
+
+        /** \brief Block until the next event arrives or the graph is mutated.
+         * \param window the window to take the event from
+         * \param event receives the event
+         * \return true if an event was received, false if the graph was mutated or the window closed
+         */
+        bool waitEvent(sf::Window &window, sf::Event &event) {
+            if(!externalMutations) return window.waitEvent(event);
+
+            std::unique_lock<std::mutex> lock(wakeMutex);
+            while(!graphMutated && window.isOpen()) {
+                lock.unlock();
+                if(window.pollEvent(event)) return true;
+                lock.lock();
+                wakeup.wait_for(lock, pollInterval, [this] { return graphMutated.load(); });
+            }
+            return false;
+        }
+
+    private:
+        /** \brief Resume the simulation; it has to stay calm for settleSweeps steps again.
+         */
+        void resume() {
+            settled = false;
+            finalPass = false;
+            calmSweeps = 0;
+        }
+
+        const double movementThreshold;
+        const unsigned settleSweeps;
+        unsigned calmSweeps = 0;
+        const std::chrono::milliseconds pollInterval{20};
+        bool settled = false;
+        bool finalPass = false;
+        bool redraw = true;
+        bool externalMutations = false;
+
+        // set by other threads under wakeMutex, so waitEvent() can't miss a wakeup
+        std::mutex wakeMutex;
+        std::condition_variable wakeup;
+        std::atomic<bool> graphMutated{false};
+};
+
+#endif // FRAMESCHEDULER_H
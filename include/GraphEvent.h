@@ -0,0 +1,90 @@
+/******************************************
+ * Graph mutation events and their textual,
+ * newline delimited representation:
+ *   add node <name> [path to image]
+ *   remove node <name>
+ *   add edge <name> <name>
+ *   remove edge <name> <name>
+ * "node ..." and "edge ..." are short forms of
+ * "add node ..." and "add edge ...", so every
+ * graph file is a valid event stream as well.
+ */
+
+#ifndef GRAPHEVENT_H
+#define GRAPHEVENT_H
+
+#include <sstream>
+#include <string>
+
+struct GraphEvent
+{
+    enum Type { ADD_NODE, REMOVE_NODE, ADD_EDGE, REMOVE_EDGE };
+
+    Type type = ADD_NODE;
+    std::string first;  // the node, or the first node of the edge
+    std::string second; // the second node of the edge
+    std::string image;  // optional image of an added node
+
+    bool isNodeEvent() const {
+        return type == ADD_NODE || type == REMOVE_NODE;
+    }
+
+    bool isAdd() const {
+        return type == ADD_NODE || type == ADD_EDGE;
+    }
+
+    /** \brief Parse a single line.
+     * \param line std::string the line without the trailing newline
+     * \param event GraphEvent& receives the event
+     * \param error std::string& receives a description if the line is malformed
+     * \return bool true if the line contains an event, false if it is empty, a comment or malformed
+     * (error is only set in the last case)
+     */
+    static bool parse(const std::string &line, GraphEvent &event, std::string &error) {
+        std::istringstream tokens(line);
+        std::string keyword;
+        error.clear();
+        if(!(tokens >> keyword) || keyword[0] == '#') return false;
+
+        bool add = true;
+        if(keyword == "add" || keyword == "remove") {
+            add = keyword == "add";
+            if(!(tokens >> keyword)) {
+                error = "missing 'node' or 'edge'";
+                return false;
+            }
+        }
+
+        event = GraphEvent();
+        if(keyword == "node") {
+            event.type = add ? ADD_NODE : REMOVE_NODE;
+            if(!(tokens >> event.first)) {
+                error = "node without name";
+                return false;
+            }
+            if(add) tokens >> event.image;
+        } else if(keyword == "edge") {
+            event.type = add ? ADD_EDGE : REMOVE_EDGE;
+            if(!(tokens >> event.first >> event.second)) {
+                error = "edge needs two node names";
+                return false;
+            }
+            if(event.first == event.second) {
+                error = "self loops are not supported";
+                return false;
+            }
+        } else {
+            error = "unknown keyword '" + keyword + "'";
+            return false;
+        }
+
+        std::string rest;
+        if(tokens >> rest) {
+            error = "unexpected '" + rest + "'";
+            return false;
+        }
+        return true;
+    }
+};
+
+#endif // GRAPHEVENT_H
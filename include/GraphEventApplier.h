@@ -0,0 +1,269 @@
+/******************************************
+ * Applies queued GraphEvents to a graph in
+ * batches. Meant to be called by the thread
+ * that owns the graph between two layout
+ * iterations.
+ */
+
+#ifndef GRAPHEVENTAPPLIER_H
+#define GRAPHEVENTAPPLIER_H
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "../Graph.hpp"
+#include "BoundedMPSCQueue.h"
+#include "GraphEvent.h"
+
+template<typename NODEVAL, typename EDGEVAL, bool isDirected = false,
+            template<typename> typename NODETYPE = Node,
+            template<typename, class, bool> typename EDGETYPE = Edge>
+class GraphEventApplier
+{
+    using TypedGraph = Graph<NODEVAL, EDGEVAL, isDirected, NODETYPE, EDGETYPE>;
+    using NODE = NODETYPE<NODEVAL>;
+
+    public:
+        /** \brief Constructor
+         * \param graph the graph to mutate
+         * \param value NODEVAL the value of nodes created by events
+         * \param placeNode called for every created node, e.g. to give it a position
+         */
+        GraphEventApplier(TypedGraph &graph, NODEVAL value, std::function<void(NODE&)> placeNode) :
+            graph(graph),
+            value(value),
+            placeNode(std::move(placeNode))
+        { };
+
+        /** \brief Make an existing node of the graph addressable by events.
+         * \param name std::string the name events use for the node
+         * \param node a pointer to the node
+         */
+        void registerNode(const std::string &name, std::shared_ptr<NODE> node) {
+            nodesByName[name] = node;
+        }
+
+        /** \brief Take up to maxEvents events from the queue, coalesce and apply them.
+         * Within a batch a node (or edge) that is added and removed again cancels out, including
+         * all edge events of such a node in between, so it never touches the graph; see coalesce().
+         * \param queue the queue to take the events from
+         * \param maxEvents size_t the maximum batch size
+         * \return size_t the number of events taken from the queue; if this equals maxEvents
+         * there may be more
+         */
+        size_t apply(BoundedMPSCQueue<GraphEvent> &queue, size_t maxEvents) {
+            batch.clear();
+            GraphEvent event;
+            while(batch.size() < maxEvents && queue.tryPop(event)) {
+                batch.push_back(std::move(event));
+            }
+
+            coalesce();
+            for(size_t i = 0; i < batch.size(); ++i) {
+                if(!cancelled[i]) applyEvent(batch[i]);
+            }
+            return batch.size();
+        }
+
+        /** \brief get the number of events that did not match the graph, e.g. edges of unknown nodes.
+         * \return the number of ignored events.
+         */
+        unsigned long ignoredEvents() const {
+            return ignored;
+        }
+
+    private:
+        TypedGraph &graph;
+        NODEVAL value;
+        std::function<void(NODE&)> placeNode;
+        std::unordered_map<std::string, std::shared_ptr<NODE> > nodesByName;
+        unsigned long ignored = 0;
+
+        // per batch state; kept as members so the buffers are reused
+        std::vector<GraphEvent> batch;
+        std::vector<bool> cancelled;
+
+        // batch index for "existed before the batch" / "not created in the batch"
+        static const size_t NONE = static_cast<size_t>(-1);
+
+        /** \brief The state of a node name while a batch is coalesced.
+         */
+        struct NodeState {
+            bool exists = false;
+            size_t createdAt = NONE;              // the add that created the current node, if it is new
+            std::vector<size_t> edgeEvents;       // the applied edge events of the current node
+            std::vector<std::string> edges;       // the identities of the edges of the current node
+        };
+
+        /** \brief The state of an edge between two particular nodes while a batch is coalesced.
+         */
+        struct EdgeState {
+            bool exists = false;
+            size_t createdAt = NONE;              // the add that created the edge, if it is new
+        };
+
+        /** \brief Replay the batch on the names of the nodes and mark every event that can be skipped:
+         * events that would be ignored or not change anything, and nodes (or edges) that are created
+         * and removed again within the batch, together with all edge events of such a node. A node
+         * that is removed and added again is a different node, so the edges of the old and the new
+         * node are told apart. Applying the remaining events has the same result as applying all.
+         */
+        void coalesce() {
+            cancelled.assign(batch.size(), false);
+
+            std::unordered_map<std::string, NodeState> nodes;
+            std::unordered_map<std::string, EdgeState> edges;
+
+            auto nodeState = [&](const std::string &name) -> NodeState& {
+                auto it = nodes.find(name);
+                if(it == nodes.end()) {
+                    it = nodes.emplace(name, NodeState()).first;
+                    it->second.exists = nodesByName.count(name) > 0;
+                }
+                return it->second;
+            };
+
+            for(size_t i = 0; i < batch.size(); ++i) {
+                const GraphEvent &event = batch[i];
+                NodeState &first = nodeState(event.first);
+
+                if(event.type == GraphEvent::ADD_NODE) {
+                    if(first.exists) {
+                        ++ignored;
+                        cancelled[i] = true;
+                        continue;
+                    }
+                    first = NodeState();
+                    first.exists = true;
+                    first.createdAt = i;
+                    continue;
+                }
+
+                if(event.type == GraphEvent::REMOVE_NODE) {
+                    if(!first.exists) {
+                        ++ignored;
+                        cancelled[i] = true;
+                        continue;
+                    }
+                    for(const std::string &edge : first.edges) {
+                        edges[edge].exists = false;
+                    }
+                    if(first.createdAt != NONE) {
+                        // the node never reaches the graph
+                        cancelled[first.createdAt] = true;
+                        cancelled[i] = true;
+                        for(size_t edgeEvent : first.edgeEvents) cancelled[edgeEvent] = true;
+                    }
+                    first = NodeState();
+                    continue;
+                }
+
+                NodeState &second = nodeState(event.second);
+                if(!first.exists || !second.exists) {
+                    ++ignored;
+                    cancelled[i] = true;
+                    continue;
+                }
+
+                std::string identity = edgeIdentity(event, first, second);
+                auto edgeIt = edges.find(identity);
+                if(edgeIt == edges.end()) {
+                    edgeIt = edges.emplace(identity, EdgeState()).first;
+                    edgeIt->second.exists = first.createdAt == NONE && second.createdAt == NONE && existsInGraph(event);
+                    if(edgeIt->second.exists) {
+                        first.edges.push_back(identity);
+                        second.edges.push_back(identity);
+                    }
+                }
+                EdgeState &edge = edgeIt->second;
+
+                if(event.type == GraphEvent::ADD_EDGE) {
+                    if(edge.exists) {
+                        // adding it again is a no-op
+                        cancelled[i] = true;
+                        continue;
+                    }
+                    edge.exists = true;
+                    edge.createdAt = i;
+                    first.edges.push_back(identity);
+                    second.edges.push_back(identity);
+                } else {
+                    if(!edge.exists) {
+                        ++ignored;
+                        cancelled[i] = true;
+                        continue;
+                    }
+                    edge.exists = false;
+                    if(edge.createdAt != NONE) {
+                        // the edge never reaches the graph
+                        cancelled[edge.createdAt] = true;
+                        cancelled[i] = true;
+                        edge.createdAt = NONE;
+                        continue;
+                    }
+                }
+                first.edgeEvents.push_back(i);
+                second.edgeEvents.push_back(i);
+            }
+        }
+
+        /** \brief check if the edge of an event was part of the graph before the batch.
+         */
+        bool existsInGraph(const GraphEvent &event) const {
+            auto firstIt = nodesByName.find(event.first), secondIt = nodesByName.find(event.second);
+            return firstIt != nodesByName.end() && secondIt != nodesByName.end() &&
+                   firstIt->second->getAdjacentNodes().count(secondIt->second) > 0;
+        }
+
+        /** \brief get a key identifying the (undirected: unordered) edge of an event between the
+         * current nodes of its two names.
+         */
+        static std::string edgeIdentity(const GraphEvent &event, const NodeState &first, const NodeState &second) {
+            auto tag = [](const std::string &name, const NodeState &state) {
+                return name + "#" + (state.createdAt == NONE ? std::string("-") : std::to_string(state.createdAt));
+            };
+            if(!isDirected && event.second < event.first) return tag(event.second, second) + " " + tag(event.first, first);
+            return tag(event.first, first) + " " + tag(event.second, second);
+        }
+
+        void applyEvent(const GraphEvent &event) {
+            auto firstIt = nodesByName.find(event.first);
+
+            if(event.type == GraphEvent::ADD_NODE) {
+                if(firstIt != nodesByName.end()) {
+                    ++ignored;
+                    return;
+                }
+                std::shared_ptr<NODE> node = graph.addNode(value);
+                if(!event.image.empty()) node->setPathToImage(event.image);
+                placeNode(*node);
+                nodesByName[event.first] = node;
+                return;
+            }
+
+            if(firstIt == nodesByName.end()) {
+                ++ignored;
+                return;
+            }
+
+            if(event.type == GraphEvent::REMOVE_NODE) {
+                graph.removeNode(firstIt->second);
+                nodesByName.erase(firstIt);
+                return;
+            }
+
+            auto secondIt = nodesByName.find(event.second);
+            if(secondIt == nodesByName.end()) {
+                ++ignored;
+            } else if(event.type == GraphEvent::ADD_EDGE) {
+                graph.addEdge(firstIt->second, secondIt->second, isDirected);
+            } else if(!graph.removeEdge(firstIt->second, secondIt->second)) {
+                ++ignored;
+            }
+        }
+};
+
+#endif // GRAPHEVENTAPPLIER_H
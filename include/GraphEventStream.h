@@ -0,0 +1,222 @@
+/******************************************
+ * Reads a newline delimited GraphEvent stream
+ * on a dedicated thread and pushes the parsed
+ * events into a BoundedMPSCQueue.
+ *
+ * Sources:
+ *   -            standard input
+ *   unix:<path>  a local (unix domain) stream socket
+ *   <path>       a file or named pipe
+ *
+ * A named pipe is reopened whenever its last writer is gone, so a
+ * restarted writer can continue the stream; all other sources end
+ * with their end of file.
+ */
+
+#ifndef GRAPHEVENTSTREAM_H
+#define GRAPHEVENTSTREAM_H
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <thread>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "BoundedMPSCQueue.h"
+#include "GraphEvent.h"
+
+class GraphEventStream
+{
+    public:
+        /** \brief Constructor
+         * \param queue the queue the events are pushed into
+         * \param onEvents called on the reader thread whenever new events were queued
+         */
+        GraphEventStream(BoundedMPSCQueue<GraphEvent> &queue, std::function<void()> onEvents) :
+            queue(queue),
+            onEvents(onEvents)
+        { };
+
+        /** \brief Stop the reader thread.
+         */
+        ~GraphEventStream()
+        {
+            stop();
+        }
+
+        GraphEventStream(const GraphEventStream&) = delete;
+        GraphEventStream &operator=(const GraphEventStream&) = delete;
+
+        /** \brief Open a source and start reading it on a new thread.
+         * \param source std::string the source, see above
+         * \return bool true if the source was opened, else false
+         */
+        bool start(const std::string &source)
+        {
+            if(reader.joinable()) return false;
+
+            int fd = openSource(source);
+            if(fd < 0) return false;
+
+            stopping = false;
+            finished = false;
+            reader = std::thread(&GraphEventStream::run, this, fd, source);
+            return true;
+        }
+
+        /** \brief Stop reading and join the reader thread. Already queued events stay queued.
+         */
+        void stop()
+        {
+            stopping = true;
+            if(reader.joinable()) reader.join();
+        }
+
+        /** \brief check if the end of the source has been reached. A named pipe only ends if it
+         * cannot be reopened.
+         * \return true if the source is exhausted or the stream was stopped, else false.
+         */
+        bool isFinished() const
+        {
+            return finished;
+        }
+
+        /** \brief get the number of lines that could not be parsed.
+         * \return the number of skipped lines.
+         */
+        unsigned long malformedLines() const
+        {
+            return malformed;
+        }
+
+    private:
+        // how often a blocked reader checks whether it should stop
+        static const int POLL_TIMEOUT_MS = 100;
+
+        BoundedMPSCQueue<GraphEvent> &queue;
+        std::function<void()> onEvents;
+        std::thread reader;
+        std::atomic<bool> stopping{false}, finished{false};
+        std::atomic<unsigned long> malformed{0};
+
+        static int openSource(const std::string &source)
+        {
+            if(source == "-") return dup(STDIN_FILENO);
+
+            if(source.compare(0, 5, "unix:") == 0) {
+                std::string path = source.substr(5);
+                sockaddr_un address;
+                if(path.size() >= sizeof(address.sun_path)) return -1;
+
+                int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+                if(fd < 0) return -1;
+                std::memset(&address, 0, sizeof(address));
+                address.sun_family = AF_UNIX;
+                std::strcpy(address.sun_path, path.c_str());
+                if(connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+                    close(fd);
+                    return -1;
+                }
+                return fd;
+            }
+
+            // non blocking, so opening a named pipe doesn't wait for a writer
+            return open(source.c_str(), O_RDONLY | O_NONBLOCK);
+        }
+
+        static bool isNamedPipe(int fd)
+        {
+            struct stat status;
+            return fstat(fd, &status) == 0 && S_ISFIFO(status.st_mode);
+        }
+
+        /** \brief Queue an event, waiting for the consumer while the queue is full.
+         * \return bool false if the stream was stopped while waiting, else true
+         */
+        bool push(GraphEvent &event)
+        {
+            while(!queue.tryPush(std::move(event))) {
+                if(stopping) return false;
+                onEvents();
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            return true;
+        }
+
+        /** \brief Queue the last line of a writer, which has no newline.
+         * \return bool false if the stream was stopped while waiting, else true
+         */
+        bool pushLastLine(std::string &pending)
+        {
+            GraphEvent event;
+            std::string error;
+            bool pushed = true;
+            if(GraphEvent::parse(pending, event, error)) {
+                pushed = push(event);
+                if(pushed) onEvents();
+            } else if(!error.empty()) {
+                ++malformed;
+            }
+            pending.clear();
+            return pushed;
+        }
+
+        void run(int fd, std::string source)
+        {
+            std::string pending;
+            char buffer[4096];
+            GraphEvent event;
+            std::string error;
+
+            while(!stopping) {
+                pollfd request = { fd, POLLIN, 0 };
+                int ready = poll(&request, 1, POLL_TIMEOUT_MS);
+                if(ready < 0 && errno != EINTR) break;
+                if(ready <= 0) continue;
+
+                ssize_t count = read(fd, buffer, sizeof(buffer));
+                if(count < 0) {
+                    if(errno == EAGAIN || errno == EINTR) continue;
+                    break;
+                }
+                if(count == 0) {
+                    // end of file, or all writers of the pipe are gone; a named pipe gets a new writer
+                    // e.g. when a monitor restarts, and the reopened pipe waits for it
+                    if(!isNamedPipe(fd) || !pushLastLine(pending)) break;
+                    close(fd);
+                    fd = openSource(source);
+                    if(fd < 0) break;
+                    continue;
+                }
+
+                pending.append(buffer, count);
+                bool queued = false;
+                size_t lineStart = 0, lineEnd;
+                while((lineEnd = pending.find('\n', lineStart)) != std::string::npos) {
+                    if(GraphEvent::parse(pending.substr(lineStart, lineEnd - lineStart), event, error)) {
+                        if(!push(event)) break;
+                        queued = true;
+                    } else if(!error.empty()) {
+                        ++malformed;
+                    }
+                    lineStart = lineEnd + 1;
+                }
+                pending.erase(0, lineStart);
+                if(queued) onEvents();
+            }
+
+            if(!stopping) pushLastLine(pending);
+
+            if(fd >= 0) close(fd);
+            finished = true;
+        }
+};
+
+#endif // GRAPHEVENTSTREAM_H
@@ -0,0 +1,195 @@
+/******************************************
+ * Reading and writing of graphs for headless
+ * (batch) usage.
+ *
+ * Graph files are line based:
+ *   # a comment
+ *   node <name> [path to image]
+ *   edge <name> <name>
+ * Nodes must be declared before they are used by an edge.
+ * The lines are parsed as GraphEvents (see GraphEvent.h).
+ */
+
+#ifndef __GRAPHIO_HPP_
+#define __GRAPHIO_HPP_
+
+#include <algorithm>
+#include <cstdio>
+#include <istream>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../Graph.hpp"
+#include "GraphEvent.h"
+
+namespace GraphIO {
+    /** \brief Read a graph file into an empty graph. The node names become the node values.
+     * \param in std::istream& the stream to read from
+     * \param graph the graph the nodes and edges are added to
+     * \param error std::string& receives a description of the first malformed line
+     * \return bool true if the whole stream was read, else false
+     */
+    template<typename EDGEVAL, bool isDirected, template<typename> typename NODETYPE,
+                template<typename, class, bool> typename EDGETYPE>
+    bool readGraph(std::istream &in, Graph<std::string, EDGEVAL, isDirected, NODETYPE, EDGETYPE> &graph, std::string &error) {
+        std::unordered_map<std::string, std::shared_ptr<NODETYPE<std::string> > > nodesByName;
+        std::string line;
+        unsigned lineNumber = 0;
+
+        while(std::getline(in, line)) {
+            ++lineNumber;
+            GraphEvent event;
+            std::string lineError;
+            if(!GraphEvent::parse(line, event, lineError)) {
+                if(lineError.empty()) continue;
+                error = "line " + std::to_string(lineNumber) + ": " + lineError;
+                return false;
+            }
+            if(!event.isAdd()) {
+                error = "line " + std::to_string(lineNumber) + ": graph files can only add nodes and edges";
+                return false;
+            }
+
+            if(event.type == GraphEvent::ADD_NODE) {
+                if(nodesByName.count(event.first)) {
+                    error = "line " + std::to_string(lineNumber) + ": duplicate node '" + event.first + "'";
+                    return false;
+                }
+                auto node = graph.addNode(event.first);
+                if(!event.image.empty()) node->setPathToImage(event.image);
+                nodesByName[event.first] = node;
+            } else {
+                auto firstIt = nodesByName.find(event.first), secondIt = nodesByName.find(event.second);
+                if(firstIt == nodesByName.end() || secondIt == nodesByName.end()) {
+                    error = "line " + std::to_string(lineNumber) + ": edge references an undeclared node";
+                    return false;
+                }
+                graph.addEdge(firstIt->second, secondIt->second, isDirected);
+            }
+        }
+        return true;
+    }
+
+    /** \brief Escape a string for use inside a JSON or XML string literal.
+     * \param value std::string the raw string
+     * \param xml bool true to escape for XML, false for JSON
+     * \return std::string the escaped string
+     */
+    static std::string escape(const std::string &value, bool xml) {
+        std::string escaped;
+        for(char c : value) {
+            if(xml) {
+                switch(c) {
+                    case '&': escaped += "&amp;"; break;
+                    case '<': escaped += "&lt;"; break;
+                    case '>': escaped += "&gt;"; break;
+                    case '"': escaped += "&quot;"; break;
+                    default: escaped += c;
+                }
+            } else if(c == '"' || c == '\\') {
+                escaped += '\\';
+                escaped += c;
+            } else if(static_cast<unsigned char>(c) < 0x20) {
+                char buffer[8];
+                std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+                escaped += buffer;
+            } else {
+                escaped += c;
+            }
+        }
+        return escaped;
+    }
+
+    /** \brief Write the node positions and edges of a graph as JSON.
+     * Nodes are numbered by their position in the graph; edges reference these numbers.
+     * \param out std::ostream& the stream to write to
+     * \param graph the graph to write
+     */
+    template<typename NODEVAL, typename EDGEVAL, bool isDirected, template<typename> typename NODETYPE,
+                template<typename, class, bool> typename EDGETYPE>
+    void writeJson(std::ostream &out, const Graph<NODEVAL, EDGEVAL, isDirected, NODETYPE, EDGETYPE> &graph) {
+        using NODE = NODETYPE<NODEVAL>;
+        std::unordered_map<const Node<NODEVAL>*, size_t> indices;
+
+        out << "{\n  \"directed\": " << (isDirected ? "true" : "false") << ",\n  \"nodes\": [";
+        for(NODE &node : graph.nodeRange()) {
+            size_t index = indices.size();
+            indices[&node] = index;
+            std::ostringstream name;
+            name << node.getValue();
+            out << (index == 0 ? "\n" : ",\n")
+                << "    {\"id\": " << index << ", \"name\": \"" << escape(name.str(), false) << "\""
+                << ", \"x\": " << node.getPosition().at(0)
+                << ", \"y\": " << node.getPosition().at(1)
+                << ", \"z\": " << node.getPosition().at(2) << "}";
+        }
+        out << "\n  ],\n  \"edges\": [";
+        bool first = true;
+        for(auto &edge : graph.edgeRange()) {
+            out << (first ? "\n" : ",\n") << "    [" << indices[edge.getFirstNode().get()]
+                << ", " << indices[edge.getSecondNode().get()] << "]";
+            first = false;
+        }
+        out << "\n  ]\n}\n";
+    }
+
+    /** \brief Render a graph as SVG the same way it is drawn on screen: edges are lines between
+     * the node centers, nodes are their image (or a circle if they have none) with the
+     * position as upper left corner. The view box is fitted to the layout.
+     * \param out std::ostream& the stream to write to
+     * \param graph the graph to write
+     * \param RADIUS unsigned the radius of the nodes
+     */
+    template<typename NODEVAL, typename EDGEVAL, bool isDirected, template<typename> typename NODETYPE,
+                template<typename, class, bool> typename EDGETYPE>
+    void writeSvg(std::ostream &out, const Graph<NODEVAL, EDGEVAL, isDirected, NODETYPE, EDGETYPE> &graph, unsigned RADIUS) {
+        using NODE = NODETYPE<NODEVAL>;
+
+        // draw back to front, like the renderer does
+        std::vector<NODE*> sortedNodes;
+        sortedNodes.reserve(graph.nodeRange().size());
+        double minX = 0, minY = 0, maxX = 0, maxY = 0;
+        for(NODE &node : graph.nodeRange()) {
+            double x = node.getPosition().at(0), y = node.getPosition().at(1);
+            if(sortedNodes.empty()) {
+                minX = maxX = x;
+                minY = maxY = y;
+            }
+            minX = std::min(minX, x);
+            minY = std::min(minY, y);
+            maxX = std::max(maxX, x);
+            maxY = std::max(maxY, y);
+            sortedNodes.push_back(&node);
+        }
+        std::sort(sortedNodes.begin(), sortedNodes.end(), [](NODE *node1, NODE *node2) { return node1->getPosition().at(2) < node2->getPosition().at(2); });
+
+        double margin = 2 * RADIUS;
+        double width = maxX - minX + 2 * RADIUS + 2 * margin, height = maxY - minY + 2 * RADIUS + 2 * margin;
+        out << "<svg xmlns=\"http://www.w3.org/2000/svg\" xmlns:xlink=\"http://www.w3.org/1999/xlink\""
+            << " width=\"" << width << "\" height=\"" << height << "\""
+            << " viewBox=\"" << minX - margin << " " << minY - margin << " " << width << " " << height << "\">\n"
+            << "<rect x=\"" << minX - margin << "\" y=\"" << minY - margin << "\" width=\"" << width << "\" height=\"" << height << "\" fill=\"black\"/>\n"
+            << "<g stroke=\"white\">\n";
+        for(NODE &node : graph.nodeRange()) {
+            for(NODE &adjacentNode : graph.adjacentNodes(node)) {
+                out << "<line x1=\"" << node.getPosition().at(0) + RADIUS << "\" y1=\"" << node.getPosition().at(1) + RADIUS
+                    << "\" x2=\"" << adjacentNode.getPosition().at(0) + RADIUS << "\" y2=\"" << adjacentNode.getPosition().at(1) + RADIUS << "\"/>\n";
+            }
+        }
+        out << "</g>\n";
+        for(NODE *node : sortedNodes) {
+            double x = node->getPosition().at(0), y = node->getPosition().at(1);
+            if(node->getPathToImage().empty()) {
+                out << "<circle cx=\"" << x + RADIUS << "\" cy=\"" << y + RADIUS << "\" r=\"" << RADIUS << "\" fill=\"white\"/>\n";
+            } else {
+                out << "<image x=\"" << x << "\" y=\"" << y << "\" width=\"" << 2 * RADIUS << "\" height=\"" << 2 * RADIUS
+                    << "\" xlink:href=\"" << escape(node->getPathToImage(), true) << "\"/>\n";
+            }
+        }
+        out << "</svg>\n";
+    }
+};
+
+#endif // __GRAPHIO_HPP_
@@ -0,0 +1,103 @@
+/******************************************
+ * A uniform spatial hash grid for 2D proximity
+ * queries. Points are bucketed into square cells;
+ * a query only visits the 3x3 cells around a point,
+ * so finding all close pairs is O(n) on average.
+ */
+
+#ifndef SPATIALHASHGRID_H
+#define SPATIALHASHGRID_H
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class SpatialHashGrid
+{
+    public:
+        /** \brief Constructor
+         * \param cellSize double the edge length of a cell; queries find every point closer than this
+         */
+        explicit SpatialHashGrid(double cellSize) : cellSize(cellSize) { };
+
+        /** \brief Remove all points and prepare the table for the given number of points.
+         * The memory is kept between calls, so rebuilding the grid every frame does not allocate.
+         * \param count size_t the number of points that will be inserted
+         */
+        void reset(size_t count)
+        {
+            size_t tableSize = 1;
+            while(tableSize < 2 * count) tableSize <<= 1;
+            mask = tableSize - 1;
+
+            buckets.assign(tableSize, size_t(NONE));
+            entries.clear();
+            entries.reserve(count);
+        }
+
+        /** \brief Insert a point.
+         * \param index size_t the handle returned by queries, e.g. the position of the point in a vector
+         * \param x double the x coordinate
+         * \param y double the y coordinate
+         */
+        void insert(size_t index, double x, double y)
+        {
+            Entry entry;
+            entry.index = index;
+            entry.cellX = cellOf(x);
+            entry.cellY = cellOf(y);
+            size_t bucket = hash(entry.cellX, entry.cellY);
+            entry.next = buckets[bucket];
+            buckets[bucket] = entries.size();
+            entries.push_back(entry);
+        }
+
+        /** \brief Call a function for every point in the 3x3 cells around a position. This is a
+         * superset of the points closer than the cell size; the caller checks the exact distance.
+         * \param x double the x coordinate
+         * \param y double the y coordinate
+         * \param visit a callable taking the index of a point
+         */
+        template<typename F>
+        void forEachNear(double x, double y, F visit) const
+        {
+            if(entries.empty()) return;
+
+            int64_t centerX = cellOf(x), centerY = cellOf(y);
+            for(int64_t cellX = centerX - 1; cellX <= centerX + 1; ++cellX) {
+                for(int64_t cellY = centerY - 1; cellY <= centerY + 1; ++cellY) {
+                    for(size_t i = buckets[hash(cellX, cellY)]; i != NONE; i = entries[i].next) {
+                        // buckets are shared by colliding cells; only report the queried one
+                        if(entries[i].cellX == cellX && entries[i].cellY == cellY) visit(entries[i].index);
+                    }
+                }
+            }
+        }
+
+    private:
+        struct Entry {
+            size_t index;
+            int64_t cellX, cellY;
+            size_t next;
+        };
+
+        static const size_t NONE = static_cast<size_t>(-1);
+
+        double cellSize;
+        size_t mask = 0;
+        std::vector<size_t> buckets;
+        std::vector<Entry> entries;
+
+        int64_t cellOf(double coordinate) const
+        {
+            return static_cast<int64_t>(std::floor(coordinate / cellSize));
+        }
+
+        size_t hash(int64_t cellX, int64_t cellY) const
+        {
+            return static_cast<size_t>((static_cast<uint64_t>(cellX) * 73856093u) ^ (static_cast<uint64_t>(cellY) * 19349663u)) & mask;
+        }
+};
+
+#endif // SPATIALHASHGRID_H
@@ -0,0 +1,158 @@
+/******************************************
+ * A work stealing thread pool. Every worker
+ * owns a task queue and steals from the other
+ * queues once its own one runs dry.
+ */
+
+#ifndef WORKSTEALINGPOOL_H
+#define WORKSTEALINGPOOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class WorkStealingPool
+{
+    public:
+        /** \brief Start the worker threads.
+         * \param threadCount unsigned the number of workers; 0 means one worker per hardware thread
+         */
+        explicit WorkStealingPool(unsigned threadCount = 0)
+        {
+            if(threadCount == 0) threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+            for(unsigned i = 0; i < threadCount; ++i) {
+                queues.emplace_back(new TaskQueue());
+            }
+            for(unsigned i = 0; i < threadCount; ++i) {
+                workers.emplace_back(&WorkStealingPool::run, this, i);
+            }
+        }
+
+        /** \brief Finish all submitted tasks and join the worker threads.
+         */
+        ~WorkStealingPool()
+        {
+            wait();
+            {
+                std::lock_guard<std::mutex> lock(stateMutex);
+                stopping = true;
+            }
+            taskAvailable.notify_all();
+            for(std::thread &worker : workers) {
+                worker.join();
+            }
+        }
+
+        WorkStealingPool(const WorkStealingPool&) = delete;
+        WorkStealingPool &operator=(const WorkStealingPool&) = delete;
+
+        /** \brief Schedule a task. Tasks are spread round robin over the worker queues;
+         * idle workers steal them from the front of the other queues.
+         * \param task the task to run; it must not throw.
+         */
+        void submit(std::function<void()> task)
+        {
+            // count the task before publishing it, so a worker can never finish it first
+            {
+                std::lock_guard<std::mutex> lock(stateMutex);
+                ++queued;
+                ++unfinished;
+            }
+            TaskQueue &queue = *queues[nextQueue++ % queues.size()];
+            {
+                std::lock_guard<std::mutex> lock(queue.mutex);
+                queue.tasks.push_back(std::move(task));
+            }
+            taskAvailable.notify_one();
+        }
+
+        /** \brief Block until every submitted task has finished.
+         */
+        void wait()
+        {
+            std::unique_lock<std::mutex> lock(stateMutex);
+            allDone.wait(lock, [this] { return unfinished == 0; });
+        }
+
+        /** \brief get the number of worker threads.
+         * \return the number of workers.
+         */
+        unsigned size() const
+        {
+            return workers.size();
+        }
+
+    private:
+        struct TaskQueue {
+            std::deque<std::function<void()> > tasks;
+            std::mutex mutex;
+        };
+
+        std::vector<std::unique_ptr<TaskQueue> > queues;
+        std::vector<std::thread> workers;
+        std::atomic<unsigned> nextQueue{0};
+
+        // guarded by stateMutex
+        std::mutex stateMutex;
+        std::condition_variable taskAvailable, allDone;
+        size_t queued = 0, unfinished = 0;
+        bool stopping = false;
+
+        /** \brief Take the newest task of the own queue (LIFO keeps caches warm).
+         */
+        bool popLocal(unsigned index, std::function<void()> &task)
+        {
+            TaskQueue &queue = *queues[index];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if(queue.tasks.empty()) return false;
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+            return true;
+        }
+
+        /** \brief Take the oldest task of another worker's queue.
+         */
+        bool steal(unsigned thief, std::function<void()> &task)
+        {
+            for(unsigned offset = 1; offset < queues.size(); ++offset) {
+                TaskQueue &queue = *queues[(thief + offset) % queues.size()];
+                std::lock_guard<std::mutex> lock(queue.mutex);
+                if(queue.tasks.empty()) continue;
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+                return true;
+            }
+            return false;
+        }
+
+        void run(unsigned index)
+        {
+            while(true) {
+                std::function<void()> task;
+                if(popLocal(index, task) || steal(index, task)) {
+                    {
+                        std::lock_guard<std::mutex> lock(stateMutex);
+                        --queued;
+                    }
+                    task();
+
+                    std::lock_guard<std::mutex> lock(stateMutex);
+                    if(--unfinished == 0) allDone.notify_all();
+                    continue;
+                }
+
+                std::unique_lock<std::mutex> lock(stateMutex);
+                taskAvailable.wait(lock, [this] { return stopping || queued > 0; });
+                if(stopping && queued == 0) return;
+            }
+        }
+};
+
+#endif // WORKSTEALINGPOOL_H
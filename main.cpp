@@ -5,14 +5,23 @@
 #include <cmath>
 #include <thread>
 #include <chrono>
+#include <iostream>
 #include "Graph.hpp"
 #include "GUINode.h"
 #include "ExpandingGraphManager.h"
+#include "FrameScheduler.h"
+#include "BoundedMPSCQueue.h"
+#include "GraphEvent.h"
+#include "GraphEventApplier.h"
+#include "GraphEventStream.h"
 
 
 #define WIDTH 1000
 #define HEIGHT 1000
 #define RADIUS 10
+#define EVENT_QUEUE_CAPACITY 65536
+#define EVENTS_PER_FRAME 2000
+#define SIMULATION_BUDGET_MS 8
 
 sf::RenderWindow window(sf::VideoMode(WIDTH, HEIGHT), "Self expanding graph");
 
@@ -23,13 +32,12 @@ void drawGraph(Graph<NODEVAL, EDGEVAL, isDirected, NODETYPE, EDGETYPE> &graph) {
 
     using NODE = NODETYPE<NODEVAL>;
 
-    for(std::shared_ptr<NODE> node : graph.getNodes()) {
-        for(std::shared_ptr<Node<sf::Color> > adjacentNode : node->getAdjacentNodes()) {
-            std::shared_ptr<GUINode<sf::Color> > adjacentGUINode = std::dynamic_pointer_cast<GUINode<sf::Color> >(adjacentNode);
+    for(NODE &node : graph.nodeRange()) {
+        for(NODE &adjacentNode : graph.adjacentNodes(node)) {
             sf::Vertex line[] =
             {
-                sf::Vertex(sf::Vector2f(node->getPosition().at(0) + RADIUS, node->getPosition().at(1)+ RADIUS)),
-                sf::Vertex(sf::Vector2f(adjacentGUINode->getPosition().at(0) + RADIUS, adjacentGUINode->getPosition().at(1) + RADIUS))
+                sf::Vertex(sf::Vector2f(node.getPosition().at(0) + RADIUS, node.getPosition().at(1)+ RADIUS)),
+                sf::Vertex(sf::Vector2f(adjacentNode.getPosition().at(0) + RADIUS, adjacentNode.getPosition().at(1) + RADIUS))
             };
 
             window.draw(line, 2, sf::Lines);
@@ -37,9 +45,13 @@ void drawGraph(Graph<NODEVAL, EDGEVAL, isDirected, NODETYPE, EDGETYPE> &graph) {
     }
 
 
-    std::vector<std::shared_ptr<NODE>> sortedNodes = graph.getNodes();
-    std::sort(sortedNodes.begin(), sortedNodes.end(), [](std::shared_ptr<NODE> node1, std::shared_ptr<NODE> node2) { return node1->getPosition().at(2) < node2->getPosition().at(2); });
-    for(std::shared_ptr<NODE> node : sortedNodes) {
+    std::vector<NODE*> sortedNodes;
+    sortedNodes.reserve(graph.nodeRange().size());
+    for(NODE &node : graph.nodeRange()) {
+        sortedNodes.push_back(&node);
+    }
+    std::sort(sortedNodes.begin(), sortedNodes.end(), [](NODE *node1, NODE *node2) { return node1->getPosition().at(2) < node2->getPosition().at(2); });
+    for(NODE *node : sortedNodes) {
         sf::Texture texture;
         texture.loadFromFile(node->getPathToImage());
         sf::Sprite sprite;
@@ -49,14 +61,11 @@ void drawGraph(Graph<NODEVAL, EDGEVAL, isDirected, NODETYPE, EDGETYPE> &graph) {
 
         window.draw(sprite);
     }
-
-
-    std::this_thread::sleep_for(std::chrono::milliseconds(10));
 }
 
 
 
-int main()
+int main(int argc, char **argv)
 {
     Graph<sf::Color, bool, false, GUINode> graph;
 
@@ -83,16 +92,55 @@ int main()
     vinothek->setPathToImage("image/vinothek_small.png");
 
 
+    // simulation and redraw are skipped while nothing changes; the frame limit replaces
+    // the fixed sleep per frame. Declared before the layout, whose multi-start runs notify it.
+    FrameScheduler scheduler;
+    window.setFramerateLimit(100);
+
     ExpandingGraphManager<sf::Color, bool, false, GUINode> gm(graph, WIDTH, HEIGHT, RADIUS);
 
+    // optional live event stream (a file, a named pipe, "-" for stdin or "unix:<path>"); the events
+    // are read on their own thread and applied between two layout iterations
+    BoundedMPSCQueue<GraphEvent> eventQueue(EVENT_QUEUE_CAPACITY);
+    GraphEventStream eventStream(eventQueue, [&scheduler] { scheduler.notifyGraphMutated(); });
+    GraphEventApplier<sf::Color, bool, false, GUINode> eventApplier(graph, sf::Color::White,
+                                                                    [&gm](GUINode<sf::Color> &node) { gm.placeNode(node); });
+    eventApplier.registerNode("openstack", openstack);
+    eventApplier.registerNode("ubuntu", ubuntu);
+    eventApplier.registerNode("java", java);
+    eventApplier.registerNode("tomcat", tomcat);
+    eventApplier.registerNode("wso2bp2", wso2bp2);
+    eventApplier.registerNode("container", container);
+    eventApplier.registerNode("admin", admin);
+    eventApplier.registerNode("winery", winery);
+    eventApplier.registerNode("modeler", modeler);
+    eventApplier.registerNode("vinothek", vinothek);
+    if(argc > 1) {
+        if(!eventStream.start(argv[1])) {
+            std::cerr << argv[1] << ": cannot open event stream" << std::endl;
+            return 1;
+        }
+    }
+
+    // problems of the event stream go to stderr, at most once per second, so a live feed can't
+    // stop or degrade silently
+    unsigned long reportedProblems = 0;
+    bool reportedEnd = false;
+    auto lastReport = std::chrono::steady_clock::now();
+
     int firstX = 0, firstY = 0;
     bool clicked = false;
     std::shared_ptr<GUINode<sf::Color> > addedNode = nullptr;
     while (window.isOpen())
     {
         sf::Event event;
-        while (window.pollEvent(event))
+        // the event stream and the multi-start runs wake a blocked main loop from other threads
+        scheduler.setExternalMutations(argc > 1 || gm.isMultiStartPending());
+        // block instead of polling once the layout has settled and the view is up to date
+        bool hasEvent = scheduler.isIdle() ? scheduler.waitEvent(window, event) : window.pollEvent(event);
+        for (; hasEvent; hasEvent = window.pollEvent(event))
         {
+            scheduler.notifyEvent(event);
             if (event.type == sf::Event::Closed) {
                 window.close();
             } else if(event.type == sf::Event::MouseButtonReleased) {
@@ -104,11 +152,18 @@ int main()
                         addedNode->setPathToImage("image/watchdog_small.png");
                         addedNode->setPosition(sf::Mouse::getPosition(window).x, sf::Mouse::getPosition(window).y, 0);
                     }
+                    scheduler.notifyGraphMutated();
 
                 }
             }
             if (event.type == sf::Event::MouseWheelMoved) {
                 gm.adjustRejectionFactor(event.mouseWheel.delta);
+                scheduler.notifyLayoutChanged();
+            }
+            // M: lay out again from several random starts on a worker thread; the view keeps running
+            // and the best result is adopted below once it is done
+            if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::M) {
+                gm.startMultiStart([&scheduler] { scheduler.notifyGraphMutated(); });
             }
         }
 
@@ -125,20 +180,53 @@ int main()
 
                 gm.turnGraphYForDegree((float)(newXPos - firstX) * 0.01);
                 gm.turnGraphXForDegree(-(float)(newYPos - firstY) * 0.01);
+                scheduler.notifyCameraChanged();
                 firstX = newXPos;
                 firstY = newYPos;
                 clicked = false;
             }
         }
 
-
-
-
-
-        window.clear();
-        drawGraph(graph);
-        gm.update();
-        window.display();
+        size_t applied = eventApplier.apply(eventQueue, EVENTS_PER_FRAME);
+        if (applied > 0) {
+            scheduler.notifyGraphMutated();
+        }
+        if (argc > 1) {
+            unsigned long problems = eventStream.malformedLines() + eventApplier.ignoredEvents();
+            bool ended = eventStream.isFinished() && applied == 0;
+            auto now = std::chrono::steady_clock::now();
+            if ((ended && !reportedEnd) || (problems != reportedProblems && now - lastReport >= std::chrono::seconds(1))) {
+                std::cerr << argv[1] << ": " << (ended ? "end of event stream, " : "")
+                          << eventStream.malformedLines() << " malformed lines, "
+                          << eventApplier.ignoredEvents() << " ignored events" << std::endl;
+                reportedProblems = problems;
+                reportedEnd = ended;
+                lastReport = now;
+            }
+        }
+        if (gm.adoptMultiStart() > 0) {
+            scheduler.notifyGraphMutated();
+        }
+        scheduler.beginFrame();
+        if (scheduler.needsSimulation()) {
+            // big graphs take several frames per sweep instead of freezing the view
+            auto progress = gm.update(std::chrono::milliseconds(SIMULATION_BUDGET_MS));
+            if (progress.sweepCompleted) {
+                scheduler.notifySimulated(progress.maxDisplacement);
+            } else {
+                scheduler.notifyPartiallySimulated(progress.maxDisplacement);
+            }
+        } else if (scheduler.needsFinalPass()) {
+            // like the batch tool: push overlapping nodes apart once the layout has settled, within
+            // the same budget per frame as the simulation
+            scheduler.notifyFinalPass(gm.removeOverlaps(std::chrono::milliseconds(SIMULATION_BUDGET_MS)));
+        }
+        if (scheduler.needsRedraw()) {
+            window.clear();
+            drawGraph(graph);
+            window.display();
+        }
+        scheduler.frameDone();
     }
 
     return 0;
@@ -0,0 +1,130 @@
+/******************************************
+ * Checks that GraphEventApplier's coalescing
+ * doesn't change the result: applying events
+ * as one batch must give the same graph as
+ * applying them one at a time.
+ *
+ * Needs the graph headers, GraphEvent.h, GraphEventApplier.h and
+ * BoundedMPSCQueue.h of include/ and PlainNode.h, none of which use
+ * SFML or armadillo. Build it from test/:
+ *   g++ -std=c++14 -O2 -I.. -I../include -o GraphEventApplierTest GraphEventApplierTest.cpp
+ *
+ * The exit code is 1 if a check failed, else 0.
+ */
+
+#include <iostream>
+#include <random>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+#include "Graph.hpp"
+#include "BoundedMPSCQueue.h"
+#include "GraphEvent.h"
+#include "GraphEventApplier.h"
+#include "PlainNode.h"
+
+
+// the events below set the image of a node to its name
+using TestGraph = Graph<int, bool, false, PlainNode>;
+using TestApplier = GraphEventApplier<int, bool, false, PlainNode>;
+
+/** \brief The nodes and edges of a graph by name.
+ */
+struct GraphState {
+    std::set<std::string> nodes;
+    std::set<std::pair<std::string, std::string> > edges;
+    bool danglingEdge = false;
+
+    bool operator==(const GraphState &other) const {
+        return nodes == other.nodes && edges == other.edges && danglingEdge == other.danglingEdge;
+    }
+};
+
+/** \brief Build the start graph (the nodes A and B and the edge A - B), apply the lines in batches
+ * of the given size and return the result.
+ */
+GraphState applyInBatches(const std::vector<std::string> &lines, size_t batchSize) {
+    TestGraph graph;
+    TestApplier applier(graph, 0, [](PlainNode<int>&) {});
+    auto a = graph.addNode(0), b = graph.addNode(0);
+    a->setPathToImage("A");
+    b->setPathToImage("B");
+    graph.addEdge(a, b);
+    applier.registerNode("A", a);
+    applier.registerNode("B", b);
+
+    BoundedMPSCQueue<GraphEvent> queue(lines.size() + 1);
+    std::string error;
+    for(const std::string &line : lines) {
+        GraphEvent event;
+        if(!GraphEvent::parse(line, event, error)) {
+            std::cerr << "cannot parse '" << line << "': " << error << std::endl;
+            continue;
+        }
+        queue.tryPush(std::move(event));
+    }
+    while(applier.apply(queue, batchSize) > 0) {}
+
+    GraphState state;
+    for(PlainNode<int> &node : graph.nodeRange()) {
+        state.nodes.insert(node.getPathToImage());
+    }
+    for(auto &edge : graph.edgeRange()) {
+        if(!graph.contains(edge.getFirstNode()) || !graph.contains(edge.getSecondNode())) state.danglingEdge = true;
+        std::string first = edge.getFirstNode()->getPathToImage(), second = edge.getSecondNode()->getPathToImage();
+        state.edges.insert(first < second ? std::make_pair(first, second) : std::make_pair(second, first));
+    }
+    return state;
+}
+
+/** \brief Compare the batched and the one at a time result of a sequence of events.
+ * \return bool true if both are equal, else false
+ */
+bool check(const std::string &name, const std::vector<std::string> &lines) {
+    GraphState batched = applyInBatches(lines, lines.size()), sequential = applyInBatches(lines, 1);
+    if(batched == sequential && applyInBatches(lines, 3) == sequential) return true;
+
+    std::cerr << "FAILED " << name << ":";
+    for(const std::string &line : lines) std::cerr << "\n  " << line;
+    std::cerr << "\n  batched: " << batched.nodes.size() << " nodes, " << batched.edges.size() << " edges"
+              << "; one at a time: " << sequential.nodes.size() << " nodes, " << sequential.edges.size() << " edges" << std::endl;
+    return false;
+}
+
+
+int main()
+{
+    unsigned failures = 0;
+
+    // an endpoint is removed and added again between two adds of the same edge
+    failures += !check("node flapping between edge adds", {
+        "remove edge A B", "add edge A B", "remove node B", "add node B B", "add edge A B" });
+    failures += !check("new edge to a flapping node", {
+        "add node C C", "add edge A C", "remove node A", "add node A A", "add edge A C" });
+    failures += !check("added and removed node", {
+        "add node C C", "add edge A C", "add edge B C", "remove node C" });
+    failures += !check("added and removed edge", {
+        "remove edge A B", "add edge A B", "remove edge A B" });
+
+    // random sequences over a few names, so adds, removes and references of unknown nodes all mix
+    const char *names[] = { "A", "B", "C", "D" };
+    std::mt19937 rng(1);
+    for(unsigned sequence = 0; sequence < 20000; ++sequence) {
+        std::vector<std::string> lines;
+        unsigned length = 1 + rng() % 10;
+        for(unsigned i = 0; i < length; ++i) {
+            std::string first = names[rng() % 4], second = names[rng() % 4];
+            switch(rng() % 4) {
+                case 0: lines.push_back("add node " + first + " " + first); break;
+                case 1: lines.push_back("remove node " + first); break;
+                case 2: if(first != second) lines.push_back("add edge " + first + " " + second); break;
+                default: if(first != second) lines.push_back("remove edge " + first + " " + second); break;
+            }
+        }
+        if(!check("random sequence " + std::to_string(sequence), lines) && ++failures >= 10) break;
+    }
+
+    std::cout << (failures == 0 ? "all checks passed" : std::to_string(failures) + " check(s) failed") << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,141 @@
+/******************************************
+ * Checks the layers LayeredGraphManager
+ * assigns: after cycle breaking every edge
+ * points downwards, long edges get one dummy
+ * vertex per layer they skip and the nodes of
+ * a layer keep their distance.
+ *
+ * Needs the graph headers, LayeredGraphManager.h of include/ (which
+ * minimises crossings on threads, hence -pthread) and PlainNode.h.
+ * Build it from test/:
+ *   g++ -std=c++14 -O2 -pthread -I.. -I../include -o LayeredGraphManagerTest LayeredGraphManagerTest.cpp
+ *
+ * The exit code is 1 if a check failed, else 0.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+#include "Graph.hpp"
+#include "LayeredGraphManager.h"
+#include "PlainNode.h"
+
+
+using TestGraph = Graph<int, bool, true, PlainNode>;
+using TestNode = PlainNode<int>;
+using TestLayout = LayeredGraphManager<int, bool, true, PlainNode>;
+
+const unsigned RADIUS = 10;
+// the defaults of LayeredGraphManager
+const double NODE_SPACING = 4.0 * RADIUS, LAYER_SPACING = 6.0 * RADIUS;
+
+/** \brief A graph built from a list of edges between numbered nodes.
+ */
+struct TestCase {
+    TestGraph graph;
+    std::vector<std::shared_ptr<TestNode> > nodes;
+
+    TestCase(unsigned nodeCount, const std::vector<std::pair<unsigned, unsigned> > &edges) {
+        for(unsigned i = 0; i < nodeCount; ++i) {
+            nodes.push_back(graph.addNode(i));
+        }
+        for(auto &edge : edges) {
+            graph.addEdge(nodes[edge.first], nodes[edge.second], true);
+        }
+    }
+
+    // cyclic graphs would keep their nodes alive
+    ~TestCase() {
+        for(TestNode &node : graph.nodeRange()) {
+            node.getAdjacentNodes().clear();
+        }
+    }
+
+    unsigned layerOf(unsigned node) const {
+        return std::lround((nodes[node]->getCoordinate(1) - LAYER_SPACING / 2) / LAYER_SPACING);
+    }
+};
+
+/** \brief Lay out a graph and check its layers: no edge may stay within a layer, at most
+ * maxUpwardEdges edges may point upwards (the reversed ones of the cycles) and the nodes of a
+ * layer must be at least the node spacing apart.
+ * \return bool true if all checks passed, else false
+ */
+bool checkLayout(const std::string &name, unsigned nodeCount, const std::vector<std::pair<unsigned, unsigned> > &edges,
+                 unsigned maxUpwardEdges) {
+    TestCase test(nodeCount, edges);
+    TestLayout layout(test.graph, 1000, 1000, RADIUS);
+
+    std::vector<std::string> errors;
+    unsigned upwardEdges = 0;
+    for(auto &edge : edges) {
+        unsigned first = test.layerOf(edge.first), second = test.layerOf(edge.second);
+        if(first == second) errors.push_back("edge " + std::to_string(edge.first) + " -> " + std::to_string(edge.second) + " within layer " + std::to_string(first));
+        if(first > second) ++upwardEdges;
+    }
+    if(upwardEdges > maxUpwardEdges) errors.push_back(std::to_string(upwardEdges) + " edges point upwards, expected at most " + std::to_string(maxUpwardEdges));
+
+    for(unsigned a = 0; a < nodeCount; ++a) {
+        for(unsigned b = a + 1; b < nodeCount; ++b) {
+            double distance = std::fabs(test.nodes[a]->getCoordinate(0) - test.nodes[b]->getCoordinate(0));
+            if(test.layerOf(a) == test.layerOf(b) && distance < NODE_SPACING - 1e-6) {
+                errors.push_back("nodes " + std::to_string(a) + " and " + std::to_string(b) + " are " + std::to_string(distance) + " apart");
+            }
+        }
+    }
+
+    if(errors.empty()) return true;
+    std::cerr << "FAILED " << name << ":";
+    for(const std::string &error : errors) std::cerr << "\n  " << error;
+    std::cerr << std::endl;
+    return false;
+}
+
+
+int main()
+{
+    unsigned failures = 0;
+
+    // a cycle can't point downwards everywhere; breaking it reverses exactly one edge
+    failures += !checkLayout("cycle", 3, { {0, 1}, {1, 2}, {2, 0} }, 1);
+    failures += !checkLayout("two cycles sharing a node", 5, { {0, 1}, {1, 2}, {2, 0}, {2, 3}, {3, 4}, {4, 2} }, 2);
+    failures += !checkLayout("two-node cycle", 2, { {0, 1}, {1, 0} }, 1);
+
+    // a long edge next to a path: 0 -> 3 spans three layers and needs two dummy vertices
+    {
+        const std::vector<std::pair<unsigned, unsigned> > edges = { {0, 1}, {1, 2}, {2, 3}, {0, 3} };
+        failures += !checkLayout("long edge", 4, edges, 0);
+
+        TestCase test(4, edges);
+        TestLayout layout(test.graph, 1000, 1000, RADIUS);
+        if(layout.getLayerCount() != 4 || layout.getDummyVertexCount() != 2 || test.layerOf(3) - test.layerOf(0) != 3) {
+            std::cerr << "FAILED long edge: " << layout.getLayerCount() << " layers, " << layout.getDummyVertexCount()
+                      << " dummy vertices, the edge spans " << test.layerOf(3) - test.layerOf(0) << " layers" << std::endl;
+            ++failures;
+        }
+    }
+
+    // random graphs; the acyclic ones (edges from lower to higher numbers) must point downwards everywhere
+    std::mt19937 rng(1);
+    for(unsigned graph = 0; graph < 300; ++graph) {
+        bool acyclic = graph % 2 == 0;
+        unsigned nodeCount = 2 + rng() % 30, edgeCount = rng() % (2 * nodeCount);
+        std::vector<std::pair<unsigned, unsigned> > edges;
+        for(unsigned e = 0; e < edgeCount; ++e) {
+            unsigned first = rng() % nodeCount, second = rng() % nodeCount;
+            if(first == second) continue;
+            if(acyclic && first > second) std::swap(first, second);
+            if(std::find(edges.begin(), edges.end(), std::make_pair(first, second)) == edges.end()) edges.emplace_back(first, second);
+        }
+        std::string name = (acyclic ? "random acyclic graph " : "random graph ") + std::to_string(graph);
+        if(!checkLayout(name, nodeCount, edges, acyclic ? 0 : edges.size()) && ++failures >= 10) break;
+    }
+
+    std::cout << (failures == 0 ? "all checks passed" : std::to_string(failures) + " check(s) failed") << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,54 @@
+/******************************************
+ * A node for the standalone tests and
+ * benchmarks: it keeps a position and an
+ * image path like GUINode, but in plain
+ * members, so they don't need armadillo.
+ */
+
+#ifndef PLAINNODE_H
+#define PLAINNODE_H
+
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include "Node.hpp"
+
+template <class T>
+class PlainNode : public Node<T>
+{
+    private:
+        double position[3] = {0, 0, 0};
+        std::string pathToImage;
+
+    public:
+        PlainNode(T value) : Node<T>(value) { };
+
+        PlainNode(T value, std::initializer_list<std::shared_ptr<PlainNode> > initlist) : Node<T>(value) {
+            for(auto node : initlist) {
+                Node<T>::addAdjacentNode(node);
+            }
+        }
+
+        /** \brief get one coordinate of the position.
+         * \param axis unsigned 0 for x, 1 for y, 2 for z
+         */
+        double getCoordinate(unsigned axis) const {
+            return position[axis];
+        }
+
+        void setPosition(double x, double y, double z) {
+            position[0] = x;
+            position[1] = y;
+            position[2] = z;
+        }
+
+        std::string getPathToImage() const {
+            return pathToImage;
+        }
+
+        void setPathToImage(std::string path) {
+            pathToImage = path;
+        }
+};
+
+#endif // PLAINNODE_H